@@ -0,0 +1,70 @@
+#include "plumed/wrapper/Plumed.h"
+#include <fstream>
+#include <vector>
+
+using namespace PLMD;
+
+// runs a short trajectory either with string commands or with handles
+void run(bool useHandles,std::ofstream&ofs){
+  int natoms=4;
+  std::vector<double> pos(3*natoms),forces(3*natoms),masses(natoms,1.0);
+  double box[3][3]={{0.0,0.0,0.0},{0.0,0.0,0.0},{0.0,0.0,0.0}};
+  double virial[3][3];
+  double bias=0.0;
+  double timestep=0.1;
+
+  Plumed p;
+  p.cmd("setNatoms",&natoms);
+  p.cmd("setMDEngine","none");
+  p.cmd("setTimestep",&timestep);
+  p.cmd("setPlumedDat","plumed.dat");
+  p.cmd("setLogFile",useHandles?"log-handles":"log-strings");
+  p.cmd("init");
+
+  int hStep=p.cmdHandle("setStep");
+  int hBox=p.cmdHandle("setBox");
+  int hMasses=p.cmdHandle("setMasses");
+  int hPositions=p.cmdHandle("setPositions");
+  int hForces=p.cmdHandle("setForces");
+  int hVirial=p.cmdHandle("setVirial");
+  int hCalc=p.cmdHandle("calc");
+  int hBias=p.cmdHandle("getBias");
+  if(useHandles) ofs<<"unknown command handle "<<p.cmdHandle("notACommand")<<"\n";
+
+  for(int step=0;step<10;step++){
+    for(int i=0;i<3*natoms;i++) pos[i]=i+0.1*step*(i%5);
+    for(int i=0;i<3*natoms;i++) forces[i]=0.0;
+    for(int i=0;i<3;i++) for(int j=0;j<3;j++) virial[i][j]=0.0;
+    if(useHandles){
+      p.hcmd(hStep,&step);
+      p.hcmd(hBox,&box[0][0]);
+      p.hcmd(hMasses,&masses[0]);
+      p.hcmd(hPositions,&pos[0]);
+      p.hcmd(hForces,&forces[0]);
+      p.hcmd(hVirial,&virial[0][0]);
+      p.hcmd(hCalc);
+      p.hcmd(hBias,&bias);
+    } else {
+      p.cmd("setStep",&step);
+      p.cmd("setBox",&box[0][0]);
+      p.cmd("setMasses",&masses[0]);
+      p.cmd("setPositions",&pos[0]);
+      p.cmd("setForces",&forces[0]);
+      p.cmd("setVirial",&virial[0][0]);
+      p.cmd("calc");
+      p.cmd("getBias",&bias);
+    }
+    ofs<<step<<" "<<bias;
+    for(int i=0;i<3*natoms;i++) ofs<<" "<<forces[i];
+    ofs<<"\n";
+  }
+}
+
+int main(){
+  std::ofstream ofs("output");
+  ofs<<"strings\n";
+  run(false,ofs);
+  ofs<<"handles\n";
+  run(true,ofs);
+  return 0;
+}
@@ -113,6 +113,7 @@ void External::registerKeywords(Keywords& keys){
   keys.add("compulsory","FILE","the name of the file containing the external potential.");
   keys.addFlag("NOSPLINE",false,"specifies that no spline interpolation is to be used when calculating the energy and forces due to the external potential");
   keys.addFlag("SPARSE",false,"specifies that the external potential uses a sparse grid");
+  keys.addFlag("CACHE_SPLINE",false,"store the spline interpolation of each grid cell as a polynomial the first time it is used. This makes evaluation faster at the price of 4^d numbers per grid point (up to three dimensions)");
   componentsAreNotOptional(keys);
   keys.addOutputComponent("bias","default","the instantaneous value of the bias potential");
 }
@@ -133,12 +134,17 @@ BiasGrid_(NULL)
   bool nospline=false;
   parseFlag("NOSPLINE",nospline);
   bool spline=!nospline;
+  bool cachespline=false;
+  parseFlag("CACHE_SPLINE",cachespline);
+  if(cachespline && !spline) error("CACHE_SPLINE cannot be used with NOSPLINE");
+  if(cachespline && sparsegrid) error("CACHE_SPLINE cannot be used with SPARSE");
 
   checkRead();
 
   log.printf("  External potential from file %s\n",filename.c_str());
   if(spline){log.printf("  External potential uses spline interpolation\n");}
   if(sparsegrid){log.printf("  External potential uses sparse grid\n");}
+  if(cachespline){log.printf("  Spline coefficients are stored for each grid cell\n");}
   
   addComponent("bias"); componentIsNotPeriodic("bias");
 
@@ -148,6 +154,10 @@ BiasGrid_(NULL)
   BiasGrid_=Grid::create(funcl,getArguments(),gridfile,sparsegrid,spline,true);
   gridfile.close();
   if(BiasGrid_->getDimension()!=getNumberOfArguments()) error("mismatch between dimensionality of input grid and number of arguments");
+  if(cachespline){
+    if(BiasGrid_->getDimension()>3) error("CACHE_SPLINE can only be used with up to three arguments");
+    BiasGrid_->setCacheSpline(true);
+  }
   for(unsigned i=0;i<getNumberOfArguments();++i){
     if( getPntrToArgument(i)->isPeriodic()!=BiasGrid_->getIsPeriodic()[i] ) error("periodicity mismatch between arguments and input bias"); 
   } 
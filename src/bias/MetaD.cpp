@@ -30,6 +30,7 @@
 #include "tools/Random.h"
 #include <string>
 #include <cstring>
+#include <cstdio>
 #include "tools/File.h"
 #include "time.h"
 #include <iostream>
@@ -206,6 +207,31 @@ id of the present walker (starting from 0 ) and the WALKERS_DIR is the directory
 where all the walkers are located. WALKERS_RSTRIDE is the number of step between 
 one update and the other. 
 
+\par
+When all the walkers run on the same node, reading the HILLS files of the other walkers
+every WALKERS_RSTRIDE steps can be slow, in particular on a network file system.
+With WALKERS_BINARY_DIR each walker also appends its hills to a binary file
+with fixed size records in the given directory, and reads only the new records from
+the binary files of the others. A node-local memory file system such as /dev/shm
+should be used, so that the hills are effectively exchanged through shared memory.
+The HILLS files in WALKERS_DIR are still written and are used when restarting.
+Each record carries the number of the hill in the HILLS file of its walker. When restarting,
+a walker appends to its binary file and the records of the hills that have already been read
+from the HILLS files are skipped, so the binary files can be either kept or removed, as long as
+all the walkers are restarted together. Without restart the binary files are overwritten,
+so all walkers should be started before any of them deposits hills.
+\verbatim
+DISTANCE ATOMS=3,5 LABEL=d1
+METAD ...
+   ARG=d1 SIGMA=0.05 HEIGHT=0.3 PACE=500 LABEL=restraint 
+   WALKERS_N=32
+   WALKERS_ID=3
+   WALKERS_DIR=../
+   WALKERS_RSTRIDE=100
+   WALKERS_BINARY_DIR=/dev/shm/myrun
+... METAD
+\endverbatim
+
 \par
 The kinetics of the transitions between basins can also be analysed on the fly as
 in \cite PRL230602. The flag ACCELERATION turn on accumulation of the acceleration
@@ -213,6 +239,22 @@ factor that can then be used to determine the rate. This method can be used toge
 with \ref COMMITTOR analysis to stop the simulation when the system get to the target basin.
 It must be used together with Well-Tempered Metadynamics.
 
+\par
+When a grid is used, restarting a long simulation can take a long time, since all
+the hills have to be read again and added to the grid. With CHECKPOINT_STRIDE
+the grid is periodically dumped in binary form, together with the number of hills
+already contained in it for each of the HILLS files. When restarting, the grid is
+loaded from the checkpoint and only the hills that were deposited after it are read.
+The HILLS files are still written as usual, and are used if the checkpoint is missing.
+\verbatim
+DISTANCE ATOMS=3,5 LABEL=d1
+METAD ...
+   ARG=d1 SIGMA=0.05 HEIGHT=0.3 PACE=500 LABEL=restraint
+   GRID_MIN=0 GRID_MAX=3 GRID_BIN=300
+   CHECKPOINT_STRIDE=50000 CHECKPOINT_FILE=METAD.ckpt
+... METAD
+\endverbatim
+
 */
 //+ENDPLUMEDOC
 
@@ -260,17 +302,35 @@ private:
   double acc;
   vector<IFile*> ifiles;
   vector<string> ifilesnames;
+/// binary files used to exchange hills among walkers, and number of records read from each of them
+/// (which is not the number of hills, since after a restart a file may start at any hill)
+  string mw_bdir_;
+  vector<string> mw_bfilesnames_;
+  vector<FILE*> mw_bfiles_;
+  vector<unsigned long> mw_brecords_;
   double uppI_;
   double lowI_;
   bool doInt_;
   bool isFirstStep;
 /// accumulator for work
   double work_;
+/// number of hills from each of the hills files that have been added to the bias
+  vector<unsigned long> nhills_;
+  int ckptstride_;
+  string ckptfilename_;
   
-  void   readGaussians(IFile*);
+  unsigned readGaussians(IFile*);
+  unsigned getPackedGaussianSize();
+  void   packGaussian(const Gaussian&,double*);
+  Gaussian unpackGaussian(const double*);
+  void   writeBinaryGaussian(const Gaussian&);
+  void   readBinaryGaussians();
+  void   writeCheckpoint();
+  bool   readCheckpoint();
   bool   readChunkOfGaussians(IFile *ifile, unsigned n);
   void   writeGaussian(const Gaussian&,OFile&);
   void   addGaussian(const Gaussian&);
+  void   addGaussians(const vector<Gaussian>&);
   double getHeight(const vector<double>&);
   double getBiasAndDerivatives(const vector<double>&,double* der=NULL);
   double evaluateGaussian(const vector<double>&, const Gaussian&,double* der=NULL);
@@ -310,6 +370,7 @@ void MetaD::registerKeywords(Keywords& keys){
   keys.add("optional","GRID_SPACING","the approximate grid spacing (to be used as an alternative or together with GRID_BIN)");
   keys.addFlag("GRID_SPARSE",false,"use a sparse grid to store hills");
   keys.addFlag("GRID_NOSPLINE",false,"don't use spline interpolation with grids");
+  keys.addFlag("GRID_CACHE_SPLINE",false,"store the spline interpolation of each grid cell as a polynomial, recomputed only for the cells that are visited after new hills are added (up to three dimensions)");
   keys.add("optional","GRID_WSTRIDE","write the grid to a file every N steps");
   keys.add("optional","GRID_WFILE","the file on which to write the grid");
   keys.addFlag("STORE_GRIDS",false,"store all the grid files the calculation generates. They will be deleted if this keyword is not present");
@@ -318,12 +379,15 @@ void MetaD::registerKeywords(Keywords& keys){
   keys.add("optional","WALKERS_N", "number of walkers");
   keys.add("optional","WALKERS_DIR", "shared directory with the hills files from all the walkers");
   keys.add("optional","WALKERS_RSTRIDE","stride for reading hills files");
+  keys.add("optional","WALKERS_BINARY_DIR","a node-local directory (e.g. /dev/shm/...) where hills are exchanged among walkers using binary files");
   keys.add("optional","INTERVAL","monodimensional lower and upper limits, outside the limits the system will not feel the biasing force.");
   keys.add("optional","GRID_RFILE","a grid file from which the bias should be read at the initial step of the simulation");
   keys.add("optional","SIGMA_MAX","the upper bounds for the sigmas (in CV units) when using adaptive hills. Negative number means no bounds ");
   keys.add("optional","SIGMA_MIN","the lower bounds for the sigmas (in CV units) when using adaptive hills. Negative number means no bounds ");
   keys.addFlag("WALKERS_MPI",false,"Switch on MPI version of multiple walkers - not compatible with other WALKERS_* options");
   keys.addFlag("ACCELERATION",false,"Set to TRUE if you want to compute the metadynamics acceleration factor.");  
+  keys.add("optional","CHECKPOINT_STRIDE","write a binary checkpoint of the grid every N steps, so as to restart without reading all the hills");
+  keys.add("optional","CHECKPOINT_FILE","the file on which the checkpoint is written (default is the name of the hills file followed by .ckpt)");
 }
 
 MetaD::~MetaD(){
@@ -337,6 +401,7 @@ MetaD::~MetaD(){
    if(ifiles[i]->isOpen()) ifiles[i]->close();
    delete ifiles[i];
   }
+  for(unsigned i=0;i<mw_bfiles_.size();++i) if(mw_bfiles_[i]) std::fclose(mw_bfiles_[i]);
 }
 
 MetaD::MetaD(const ActionOptions& ao):
@@ -356,7 +421,8 @@ acceleration(false), acc(0.0),
 // Interval initialization
 uppI_(-1), lowI_(-1), doInt_(false),
 work_(0.0),
-isFirstStep(true)
+isFirstStep(true),
+ckptstride_(0)
 {
   // parse the flexible hills
   string adaptiveoption;
@@ -492,7 +558,15 @@ isFirstStep(true)
   bool nospline=false;
   parseFlag("GRID_NOSPLINE",nospline);
   bool spline=!nospline;
+  bool cachespline=false;
+  parseFlag("GRID_CACHE_SPLINE",cachespline);
   if(gbin.size()>0){grid_=true;}
+  if(cachespline){
+    if(!grid_) error("GRID_CACHE_SPLINE can only be used with a grid");
+    if(!spline) error("GRID_CACHE_SPLINE cannot be used with GRID_NOSPLINE");
+    if(sparsegrid) error("GRID_CACHE_SPLINE cannot be used with GRID_SPARSE");
+    if(getNumberOfArguments()>3) error("GRID_CACHE_SPLINE can only be used with up to three arguments");
+  }
   parse("GRID_WSTRIDE",wgridstride_);
   parse("GRID_WFILE",gridfilename_); 
   parseFlag("STORE_GRIDS",storeOldGrids_);
@@ -512,6 +586,8 @@ isFirstStep(true)
   if(mw_n_<=mw_id_) error("walker ID should be a numerical value less than the total number of walkers");
   parse("WALKERS_DIR",mw_dir_);
   parse("WALKERS_RSTRIDE",mw_rstride_);
+  parse("WALKERS_BINARY_DIR",mw_bdir_);
+  if(mw_bdir_.length()>0 && mw_n_==1) error("WALKERS_BINARY_DIR can only be used with WALKERS_N");
 
   // MPI version
   parseFlag("WALKERS_MPI",walkers_mpi);
@@ -531,6 +607,14 @@ isFirstStep(true)
   acceleration=false;
   parseFlag("ACCELERATION",acceleration);
 
+  parse("CHECKPOINT_STRIDE",ckptstride_);
+  ckptfilename_=hillsfname+".ckpt";
+  parse("CHECKPOINT_FILE",ckptfilename_);
+  if(ckptstride_>0){
+    if(!grid_) error("CHECKPOINT_STRIDE can only be used with a grid");
+    if(sparsegrid) error("CHECKPOINT_STRIDE cannot be used with GRID_SPARSE");
+  }
+
   checkRead();
 
   log.printf("  Gaussian width ");
@@ -558,11 +642,13 @@ isFirstStep(true)
    log.printf("\n");
    if(spline){log.printf("  Grid uses spline interpolation\n");}
    if(sparsegrid){log.printf("  Grid uses sparse grid\n");}
+   if(cachespline){log.printf("  Spline coefficients are stored for each grid cell\n");}
    if(wgridstride_>0){log.printf("  Grid is written on file %s with stride %d\n",gridfilename_.c_str(),wgridstride_);} 
   }
   if(gridreadfilename_.length()>0){
 	   log.printf("  Reading an additional bias from grid in file %s \n",gridreadfilename_.c_str());
   }
+  if(ckptstride_>0) log.printf("  Checkpoint of the grid is written on file %s with stride %d\n",ckptfilename_.c_str(),ckptstride_);
 
 
   if(mw_n_>1){
@@ -571,6 +657,7 @@ isFirstStep(true)
    log.printf("  walker id %d\n",mw_id_);
    log.printf("  reading stride %d\n",mw_rstride_);
    log.printf("  directory with hills files %s\n",mw_dir_.c_str());
+   if(mw_bdir_.length()>0) log.printf("  hills are exchanged using binary files in directory %s\n",mw_bdir_.c_str());
   } else {
    if(walkers_mpi) log.printf("  Multiple walkers active using MPI communnication\n"); 
   }
@@ -602,6 +689,7 @@ isFirstStep(true)
    std::string funcl=getLabel() + ".bias";
    if(!sparsegrid){BiasGrid_=new Grid(funcl,getArguments(),gmin,gmax,gbin,spline,true);}
    else{BiasGrid_=new SparseGrid(funcl,getArguments(),gmin,gmax,gbin,spline,true);}
+   if(cachespline) BiasGrid_->setCacheSpline(true);
    std::vector<std::string> actualmin=BiasGrid_->getMin();
    std::vector<std::string> actualmax=BiasGrid_->getMax();
    for(unsigned i=0;i<getNumberOfArguments();i++){
@@ -630,6 +718,11 @@ isFirstStep(true)
   }
 
 
+// when restarting from a checkpoint, the hills that are already in the grid are skipped
+  nhills_.assign(mw_n_,0);
+  bool fromCheckpoint=false;
+  if(getRestart() && ckptstride_>0) fromCheckpoint=readCheckpoint();
+
 // creating vector of ifile* for hills reading 
 // open all files at the beginning and read Gaussians if restarting
   for(int i=0;i<mw_n_;++i){
@@ -647,8 +740,12 @@ isFirstStep(true)
    if(ifile->FileExist(fname)){
     ifile->open(fname);
     if(getRestart()){
+     if(fromCheckpoint && nhills_[i]>0){
+       log.printf("  Skipping %lu Gaussians from %s that are already in the checkpoint\n",nhills_[i],ifilesnames[i].c_str());
+       if(!ifile->skipFields(nhills_[i])) error("hills file " + ifilesnames[i] + " contains less hills than the checkpoint " + ckptfilename_);
+     }
      log.printf("  Restarting from %s:",ifilesnames[i].c_str());                  
-     readGaussians(ifiles[i]);                                                    
+     nhills_[i]+=readGaussians(ifiles[i]);                                                    
     }
     ifiles[i]->reset(false);
     // close only the walker own hills file for later writing
@@ -656,6 +753,20 @@ isFirstStep(true)
    }
   }
 
+// the own binary file is created empty, or appended to when restarting, the others are opened when they appear
+  if(mw_bdir_.length()>0){
+    for(int i=0;i<mw_n_;++i){
+      stringstream out; out << i;
+      mw_bfilesnames_.push_back(mw_bdir_+"/"+hillsfname+".bin."+out.str());
+    }
+    mw_bfiles_.assign(mw_n_,(FILE*)NULL);
+    mw_brecords_.assign(mw_n_,0);
+    if(comm.Get_rank()==0){
+      mw_bfiles_[mw_id_]=std::fopen(mw_bfilesnames_[mw_id_].c_str(),(getRestart()?"ab":"wb"));
+      if(!mw_bfiles_[mw_id_]) error("cannot open binary hills file " + mw_bfilesnames_[mw_id_]);
+    }
+  }
+
 // open hills file for writing
   hillsOfile_.link(*this);
   if(walkers_mpi){
@@ -691,7 +802,7 @@ isFirstStep(true)
 
 }
 
-void MetaD::readGaussians(IFile *ifile)
+unsigned MetaD::readGaussians(IFile *ifile)
 {
  unsigned ncv=getNumberOfArguments();
  vector<double> center(ncv);
@@ -709,6 +820,7 @@ void MetaD::readGaussians(IFile *ifile)
   addGaussian(Gaussian(center,sigma,height,multivariate));
  }     
  log.printf("      %d Gaussians read\n",nhills);
+ return nhills;
 }
 
 bool MetaD::readChunkOfGaussians(IFile *ifile, unsigned n)
@@ -784,14 +896,30 @@ void MetaD::writeGaussian(const Gaussian& hill, OFile&file){
 
 void MetaD::addGaussian(const Gaussian& hill)
 {
- if(!grid_){hills_.push_back(hill);} 
+ addGaussians(vector<Gaussian>(1,hill));
+}
+
+void MetaD::addGaussians(const vector<Gaussian>& newhills)
+{
+ if(!grid_){hills_.insert(hills_.end(),newhills.begin(),newhills.end());} 
  else{
   unsigned ncv=getNumberOfArguments();
-  vector<unsigned> nneighb=getGaussianSupport(hill);
-  vector<unsigned> neighbors=BiasGrid_->getNeighbors(hill.center,nneighb);
   vector<double> der(ncv);
   vector<double> xx(ncv);
+// hills with a diagonal metric are products of one dimensional Gaussians, so they are
+// deposited as an outer product by every process, which is cheaper than splitting their points
+  vector<Gaussian> flexhills;
+  for(unsigned k=0;k<newhills.size();++k){
+   const Gaussian & hill(newhills[k]);
+   if(hill.multivariate || doInt_) flexhills.push_back(hill);
+   else BiasGrid_->addSeparableGaussian(hill.center,hill.invsigma,hill.height,getGaussianSupport(hill),DP2CUTOFF);
+  }
+  if(flexhills.empty()) return;
   if(comm.Get_size()==1){
+   for(unsigned k=0;k<flexhills.size();++k){
+    const Gaussian & hill(flexhills[k]);
+    vector<unsigned> nneighb=getGaussianSupport(hill);
+    vector<unsigned> neighbors=BiasGrid_->getNeighbors(hill.center,nneighb);
     for(unsigned i=0;i<neighbors.size();++i){
      unsigned ineigh=neighbors[i];
      for(unsigned j=0;j<ncv;++j){der[j]=0.0;}
@@ -799,22 +927,33 @@ void MetaD::addGaussian(const Gaussian& hill)
      double bias=evaluateGaussian(xx,hill,&der[0]);
      BiasGrid_->addValueAndDerivatives(ineigh,bias,der);
     } 
+   }
   } else {
+// the grid points of all the hills are put in a single list, which is split among the processes,
+// so that there is a single reduction also when many hills are added together
+    vector<unsigned> neighbors;
+    vector<unsigned> hillstart(flexhills.size()+1,0);
+    for(unsigned k=0;k<flexhills.size();++k){
+     vector<unsigned> nneighb=getGaussianSupport(flexhills[k]);
+     vector<unsigned> hillneighbors=BiasGrid_->getNeighbors(flexhills[k].center,nneighb);
+     neighbors.insert(neighbors.end(),hillneighbors.begin(),hillneighbors.end());
+     hillstart[k+1]=neighbors.size();
+    }
     unsigned stride=comm.Get_size();
     unsigned rank=comm.Get_rank();
-    vector<double> allder(ncv*neighbors.size(),0.0);
-    vector<double> allbias(neighbors.size(),0.0);
-    for(unsigned i=rank;i<neighbors.size();i+=stride){
-     unsigned ineigh=neighbors[i];
-     BiasGrid_->getPoint(ineigh,xx);
-     allbias[i]=evaluateGaussian(xx,hill,&allder[ncv*i]);
+    vector<double> all((ncv+1)*neighbors.size(),0.0);
+    for(unsigned k=0;k<flexhills.size();++k){
+     for(unsigned i=hillstart[k]+rank;i<hillstart[k+1];i+=stride){
+      unsigned ineigh=neighbors[i];
+      BiasGrid_->getPoint(ineigh,xx);
+      all[(ncv+1)*i]=evaluateGaussian(xx,flexhills[k],&all[(ncv+1)*i+1]);
+     }
     }
-    comm.Sum(allbias);
-    comm.Sum(allder);
+    comm.Sum(all);
     for(unsigned i=0;i<neighbors.size();++i){
      unsigned ineigh=neighbors[i];
-     for(unsigned j=0;j<ncv;++j){der[j]=allder[ncv*i+j];}
-     BiasGrid_->addValueAndDerivatives(ineigh,allbias[i],der);
+     for(unsigned j=0;j<ncv;++j){der[j]=all[(ncv+1)*i+1+j];}
+     BiasGrid_->addValueAndDerivatives(ineigh,all[(ncv+1)*i],der);
     }
   }
  }
@@ -1066,38 +1205,29 @@ void MetaD::update(){
 // info abount number of walkers and walker index
      comm.Bcast(nw,0);
      comm.Bcast(mw,0);
-// Allocate arrays to store all walkers hills
-     std::vector<double> all_cv(nw*cv.size(),0.0);
-     std::vector<double> all_sigma(nw*thissigma.size(),0.0);
-     std::vector<double> all_height(nw,0.0);
-     std::vector<int>    all_multivariate(nw,0);
-     if(comm.Get_rank()==0){
-// Communicate (only root)
-       multi_sim_comm.Allgather(cv,all_cv);
-       multi_sim_comm.Allgather(thissigma,all_sigma);
-       multi_sim_comm.Allgather(height,all_height);
-       multi_sim_comm.Allgather(int(multivariate),all_multivariate);
-     }
-// Share info with group members
-     comm.Bcast(all_cv,0);
-     comm.Bcast(all_sigma,0);
-     comm.Bcast(all_height,0);
-     comm.Bcast(all_multivariate,0);
+// All the data of a hill are packed in a single buffer, so that there is
+// a single Allgather among walkers and a single Bcast inside the group
+     const unsigned npacked=getPackedGaussianSize();
+     std::vector<double> packed(npacked);
+     std::vector<double> all_packed(nw*npacked,0.0);
+     packGaussian(Gaussian(cv,thissigma,height,multivariate),&packed[0]);
+     if(comm.Get_rank()==0) multi_sim_comm.Allgather(packed,all_packed);
+     comm.Bcast(all_packed,0);
+     std::vector<Gaussian> newhills;
+     for(int i=0;i<nw;i++) newhills.push_back(unpackGaussian(&all_packed[i*npacked]));
+// all the hills are added to the grid in a single pass
+     addGaussians(newhills);
      for(int i=0;i<nw;i++){
-// actually add hills one by one
-       std::vector<double> cv_now(cv.size());
-       std::vector<double> sigma_now(thissigma.size());
-       for(unsigned j=0;j<cv.size();j++) cv_now[j]=all_cv[i*cv.size()+j];
-       for(unsigned j=0;j<thissigma.size();j++) sigma_now[j]=all_sigma[i*thissigma.size()+j];
-       Gaussian newhill=Gaussian(cv_now,sigma_now,all_height[i],all_multivariate[i]);
-       addGaussian(newhill);
-       writeGaussian(newhill,hillsOfile_);
+       writeGaussian(newhills[i],hillsOfile_);
+       nhills_[mw_id_]++;
      }
    } else {
      Gaussian newhill=Gaussian(cv,thissigma,height,multivariate);
      addGaussian(newhill);
 // print on HILLS file
      writeGaussian(newhill,hillsOfile_);
+     nhills_[mw_id_]++;
+     if(mw_bdir_.length()>0) writeBinaryGaussian(newhill);
    }
   }
 
@@ -1122,8 +1252,12 @@ void MetaD::update(){
     if(!storeOldGrids_) gridfile_.flush();
   }
 
+  if(ckptstride_>0 && getStep()%ckptstride_==0) writeCheckpoint();
+
 // if multiple walkers and time to read Gaussians
- if(mw_n_>1 && getStep()%mw_rstride_==0){
+ if(mw_n_>1 && getStep()%mw_rstride_==0 && mw_bdir_.length()>0){
+   readBinaryGaussians();
+ } else if(mw_n_>1 && getStep()%mw_rstride_==0){
    for(int i=0;i<mw_n_;++i){
     // don't read your own Gaussians
     if(i==mw_id_) continue;
@@ -1137,13 +1271,178 @@ void MetaD::update(){
     // otherwise read the new Gaussians 
     } else {
      log.printf("  Reading hills from %s:",ifilesnames[i].c_str());
-     readGaussians(ifiles[i]);
+     nhills_[i]+=readGaussians(ifiles[i]);
      ifiles[i]->reset(false);
     }
    }
  } 
 }
 
+// A packed Gaussian contains the center, the sigmas (with room for a full matrix), the height
+// and the multivariate flag. It is used to communicate hills among walkers.
+unsigned MetaD::getPackedGaussianSize(){
+  const unsigned ncv=getNumberOfArguments();
+  return ncv + ncv*(ncv+1)/2 + 2;
+}
+
+void MetaD::packGaussian(const Gaussian& hill,double*packed){
+  const unsigned ncv=getNumberOfArguments();
+  const unsigned npacked=getPackedGaussianSize();
+  for(unsigned i=0;i<npacked;++i) packed[i]=0.0;
+  for(unsigned i=0;i<ncv;++i) packed[i]=hill.center[i];
+  for(unsigned i=0;i<hill.sigma.size();++i) packed[ncv+i]=hill.sigma[i];
+  packed[npacked-2]=hill.height;
+  packed[npacked-1]=(hill.multivariate?1.0:0.0);
+}
+
+MetaD::Gaussian MetaD::unpackGaussian(const double*packed){
+  const unsigned ncv=getNumberOfArguments();
+  const unsigned npacked=getPackedGaussianSize();
+  const bool multivariate=(packed[npacked-1]>0.5);
+  vector<double> center(packed,packed+ncv);
+  vector<double> sigma(packed+ncv,packed+ncv+(multivariate?ncv*(ncv+1)/2:ncv));
+  return Gaussian(center,sigma,packed[npacked-2],multivariate);
+}
+
+// Each record of the binary hills files contains a packed Gaussian followed by a sequence number,
+// which is the number of the hill in the HILLS file of the walker, so it starts from the hills read
+// back from that file when restarting. The sequence number is written last and is used by the readers
+// to check that the record is complete and to skip the hills that they have already read.
+void MetaD::writeBinaryGaussian(const Gaussian& hill){
+  if(comm.Get_rank()!=0) return;
+  const unsigned nrec=getPackedGaussianSize()+1;
+  vector<double> record(nrec);
+  packGaussian(hill,&record[0]);
+  record[nrec-1]=nhills_[mw_id_];
+  FILE* fp=mw_bfiles_[mw_id_];
+  if(std::fwrite(&record[0],sizeof(double),nrec,fp)!=nrec) error("error writing binary hills file " + mw_bfilesnames_[mw_id_]);
+  std::fflush(fp);
+}
+
+void MetaD::readBinaryGaussians(){
+  const unsigned nrec=getPackedGaussianSize()+1;
+// the new records are read by the root of the group, each of them preceded by the walker index
+  vector<double> data;
+  if(comm.Get_rank()==0){
+    vector<double> record(nrec);
+    for(int i=0;i<mw_n_;++i){
+      if(i==mw_id_) continue;
+      if(!mw_bfiles_[i]){
+        mw_bfiles_[i]=std::fopen(mw_bfilesnames_[i].c_str(),"rb");
+        if(!mw_bfiles_[i]) continue;
+      }
+      FILE* fp=mw_bfiles_[i];
+      const long offset=long(mw_brecords_[i]*nrec*sizeof(double));
+      std::fseek(fp,0,SEEK_END);
+      if(std::ftell(fp)<offset) error("binary hills file " + mw_bfilesnames_[i] + " is shorter than the part already read:"
+                                      " it has been overwritten, possibly by a walker that was restarted alone");
+// restart from the end of the last complete record, this also clears the end of file flag
+      std::fseek(fp,offset,SEEK_SET);
+      unsigned long last=nhills_[i];
+      while(std::fread(&record[0],sizeof(double),nrec,fp)==nrec && record[nrec-1]>=1.0){
+        mw_brecords_[i]++;
+        const unsigned long seq=(unsigned long)(record[nrec-1]);
+// hills already read from the HILLS file when restarting
+        if(seq<=last) continue;
+        if(seq!=last+1) error("binary hills file " + mw_bfilesnames_[i] + " has a gap in the hill numbers:"
+                              " it has probably been removed while the walkers were running");
+        data.push_back(i);
+        data.insert(data.end(),record.begin(),record.end());
+        last++;
+      }
+    }
+  }
+  unsigned ndata=data.size();
+  comm.Bcast(ndata,0);
+  if(ndata==0) return;
+  data.resize(ndata);
+  comm.Bcast(data,0);
+  vector<unsigned> nread(mw_n_,0);
+  vector<Gaussian> newhills;
+  for(unsigned k=0;k<ndata;k+=nrec+1){
+    const int iwalker=int(data[k]);
+    newhills.push_back(unpackGaussian(&data[k+1]));
+    nhills_[iwalker]++;
+    nread[iwalker]++;
+  }
+  addGaussians(newhills);
+  for(int i=0;i<mw_n_;++i) if(nread[i]>0) log.printf("  Reading hills from %s:      %u Gaussians read\n",mw_bfilesnames_[i].c_str(),nread[i]);
+}
+
+// The checkpoint is a binary file containing a header, the number of hills
+// read from each of the hills files and then the values and derivatives of the bias on the grid
+static const char ckptMagic[8]={'P','L','M','D','C','K','P','1'};
+
+void MetaD::writeCheckpoint(){
+// the hills that are counted in the checkpoint should be on disk already
+  hillsOfile_.flush();
+  if(comm.Get_rank()!=0) return;
+  const unsigned ncv=getNumberOfArguments();
+  const unsigned npoints=BiasGrid_->getSize();
+  const unsigned nfiles=nhills_.size();
+  vector<double> buffer(npoints*(ncv+1));
+  vector<double> der(ncv);
+  for(unsigned i=0;i<npoints;i++){
+    buffer[i*(ncv+1)]=BiasGrid_->getValueAndDerivatives(i,der);
+    for(unsigned j=0;j<ncv;j++) buffer[i*(ncv+1)+1+j]=der[j];
+  }
+// the checkpoint is written on a temporary file and then moved, so that
+// a crash while writing does not destroy the previous one
+  const string fname=FileBase::appendSuffix(ckptfilename_,plumed.getSuffix());
+  const string tmpname=fname+".tmp";
+  FILE* fp=std::fopen(tmpname.c_str(),"wb");
+  if(!fp) error("cannot open checkpoint file " + tmpname);
+  bool ok=true;
+  ok = ok && std::fwrite(ckptMagic,sizeof(char),8,fp)==8;
+  ok = ok && std::fwrite(&ncv,sizeof(unsigned),1,fp)==1;
+  ok = ok && std::fwrite(&npoints,sizeof(unsigned),1,fp)==1;
+  ok = ok && std::fwrite(&nfiles,sizeof(unsigned),1,fp)==1;
+  ok = ok && std::fwrite(&nhills_[0],sizeof(unsigned long),nfiles,fp)==nfiles;
+  ok = ok && std::fwrite(&buffer[0],sizeof(double),buffer.size(),fp)==buffer.size();
+  ok = (std::fclose(fp)==0) && ok;
+  if(!ok) error("error writing checkpoint file " + tmpname);
+  if(std::rename(tmpname.c_str(),fname.c_str())!=0) error("cannot move checkpoint file " + tmpname + " to " + fname);
+}
+
+bool MetaD::readCheckpoint(){
+  const unsigned ncv=getNumberOfArguments();
+  const unsigned npoints=BiasGrid_->getSize();
+  const unsigned nfiles=nhills_.size();
+  const string fname=FileBase::appendSuffix(ckptfilename_,plumed.getSuffix());
+  vector<double> buffer(npoints*(ncv+1));
+// 0: no checkpoint, 1: checkpoint read, 2: checkpoint incompatible with the input
+  int status=0;
+  if(comm.Get_rank()==0){
+    FILE* fp=std::fopen(fname.c_str(),"rb");
+    if(fp){
+      char magic[8];
+      unsigned header[3];
+      status=2;
+      if(std::fread(magic,sizeof(char),8,fp)==8 && std::memcmp(magic,ckptMagic,8)==0 &&
+         std::fread(header,sizeof(unsigned),3,fp)==3 &&
+         header[0]==ncv && header[1]==npoints && header[2]==nfiles &&
+         std::fread(&nhills_[0],sizeof(unsigned long),nfiles,fp)==nfiles &&
+         std::fread(&buffer[0],sizeof(double),buffer.size(),fp)==buffer.size()) status=1;
+      std::fclose(fp);
+    }
+  }
+  comm.Bcast(status,0);
+  if(status==0){
+    log.printf("  Checkpoint file %s not found, all the hills will be read\n",fname.c_str());
+    return false;
+  }
+  if(status==2) error("checkpoint file " + fname + " cannot be read or does not match the grid and the number of walkers");
+  comm.Bcast(nhills_,0);
+  comm.Bcast(buffer,0);
+  vector<double> der(ncv);
+  for(unsigned i=0;i<npoints;i++){
+    for(unsigned j=0;j<ncv;j++) der[j]=buffer[i*(ncv+1)+1+j];
+    BiasGrid_->setValueAndDerivatives(i,buffer[i*(ncv+1)],der);
+  }
+  log.printf("  Grid read from checkpoint file %s\n",fname.c_str());
+  return true;
+}
+
 void MetaD::finiteDifferenceGaussian
  (const vector<double>& cv, const Gaussian& hill)
 {
@@ -75,7 +75,24 @@ all the others will be integrated out. --kt defines the temperature of the syste
 If you need more variables then you may use a comma separated syntax
 
 \verbatim
-plumed sum_hills  --hills PATHTOMYHILLSFILE   --idw t1,t2 --kt 0.6  
+plumed sum_hills  --hills PATHTOMYHILLSFILE   --idw t1,t2 --kt 0.6
+\endverbatim
+
+Several projections can be obtained at once by separating the sets of variables with a colon.
+They are all computed in a single pass on the grid, and each of them is written on a file
+whose name ends with its variables (here fes_t1.dat, fes_t2.dat and fes_t1_t2.dat)
+
+\verbatim
+plumed sum_hills  --hills PATHTOMYHILLSFILE   --idw t1:t2:t1,t2 --kt 0.6
+\endverbatim
+
+Summing the hills and integrating large grids can be expensive: both are done with openMP threads
+(see \ref Openmp) and can be also split among processes by running
+sum_hills with mpirun. Hills are added to the grid in chunks, and processes only
+communicate when a grid is written, so this also works well together with --stride
+
+\verbatim
+mpirun -np 4 plumed sum_hills  --hills PATHTOMYHILLSFILE   --idw t1 --kt 0.6
 \endverbatim
 
 You can define the output grid only with the number of bins you want 
@@ -207,7 +224,7 @@ void CLToolSumHills::registerKeywords( Keywords& keys ){
   keys.add("optional","--max","the upper bounds for the grid");
   keys.add("optional","--bin","the number of bins for the grid");
   keys.add("optional","--spacing","grid spacing, alternative to the number of bins");
-  keys.add("optional","--idw","specify the variables to be used for the free-energy/histogram (default is all). With --hills the other variables will be integrated out, with --histo the other variables won't be considered");
+  keys.add("optional","--idw","specify the variables to be used for the free-energy/histogram (default is all). With --hills the other variables will be integrated out, with --histo the other variables won't be considered. With --hills several sets of variables separated by a colon give several projections");
   keys.add("optional","--outfile","specify the outputfile for sumhills");
   keys.add("optional","--outhisto","specify the outputfile for the histogram");
   keys.add("optional","--kt","specify temperature in energy units for integrating out variables");
@@ -394,8 +411,14 @@ int CLToolSumHills::main(FILE* in,FILE*out,Communicator& pc){
   unsigned ncv=cvs.size();
   std::vector<std::string> actioninput;
   vector<std::string> idw;
+  vector< vector<std::string> > idwsets;
   // check if the variables to be used are correct 
-  if(parseVector("--idw",idw)){
+  std::string idwstring;
+  if(parse("--idw",idwstring)){
+      std::vector<std::string> sets=Tools::getWords(idwstring,":");
+      for(unsigned i=0;i<sets.size();i++) idwsets.push_back( Tools::getWords(sets[i],",") );
+      for(unsigned i=0;i<idwsets.size();i++) idw.insert( idw.end(), idwsets[i].begin(), idwsets[i].end() );
+      if(idwsets.size()>1 && dohisto) plumed_merror("several sets of variables in --idw can only be used with --hills");
       for(unsigned i=0;i<idw.size();i++){
           bool found=false;
           for(unsigned j=0;j<cvs.size();j++){
@@ -407,7 +430,7 @@ int CLToolSumHills::main(FILE* in,FILE*out,Communicator& pc){
           }
           if(!found)plumed_merror("variable "+idw[i]+" is not found in the bunch of cvs: revise your --idw option" ); 
       } 
-      plumed_massert( idw.size()<=cvs.size() ,"the number of variables to be integrated should be at most equal to the total number of cvs  "); 
+      for(unsigned i=0;i<idwsets.size();i++) plumed_massert( idwsets[i].size()<=cvs.size() ,"the number of variables to be integrated should be at most equal to the total number of cvs  "); 
       // in this case you neeed a beta factor!
   } 
 
@@ -482,10 +505,12 @@ int CLToolSumHills::main(FILE* in,FILE*out,Communicator& pc){
   if(mintozero){
      actioninput.push_back("MINTOZERO");
   }
-  if(idw.size()!=0){ 
-     addme="PROJ=";
-     for(unsigned i=0;i<idw.size()-1;i++){addme+=idw[i]+",";}
-     addme+=idw.back();  
+  for(unsigned k=0;k<idwsets.size();k++){ 
+     addme="PROJ";
+     if(idwsets.size()>1){ std::string num; Tools::convert(k+1,num); addme+=num; }
+     addme+="=";
+     for(unsigned i=0;i<idwsets[k].size()-1;i++){addme+=idwsets[k][i]+",";}
+     addme+=idwsets[k].back();  
      actioninput.push_back(addme);
   }
 
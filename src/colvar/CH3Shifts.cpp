@@ -122,11 +122,16 @@ class CH3Shifts : public Colvar {
   double ene_pl2alm;
   double len_pl2alm;
   double for_pl2alm;
+  // quantities that are kept between calculate() and finishCalculation()
+  Coor<double> coor;
+  Coor<double> forces;
+  double energy;
 public:
   CH3Shifts(const ActionOptions&);
   ~CH3Shifts();
   static void registerKeywords( Keywords& keys );
   virtual void calculate();
+  virtual void finishCalculation();
 };
 
 PLUMED_REGISTER_ACTION(CH3Shifts,"CH3SHIFTS")
@@ -258,6 +263,8 @@ PLUMED_COLVAR_INIT(ao)
   vector<AtomNumber> atoms;
   parseAtomList("ATOMS",atoms);
   checkRead();
+  coor.resize(atoms.size());
+  forces.resize(atoms.size());
 
   log<<"  Bibliography "
      <<plumed.cite("Sahakyan AB, Vranken WF, Cavalli A, Vendruscolo M, J. Biomol. NMR 50, 331 (2011)")
@@ -277,13 +284,8 @@ CH3Shifts::~CH3Shifts()
 
 void CH3Shifts::calculate()
 {
-  double energy=0.;
-  Tensor virial;
-  virial.zero();
-  vector<Vector> deriv(getNumberOfAtoms());
+  energy=0.;
   int N = getNumberOfAtoms();
-  Coor<double> coor(N); 
-  Coor<double> forces(N);
 
   forces.clear();
   for(int i=0; i<numResidues; i++) for(unsigned j=0; j<6; j++) sh[i][j]=0.;
@@ -301,10 +303,10 @@ void CH3Shifts::calculate()
   if(pperiod>0&&comm.Get_rank()==0) printout = (!(getStep()%pperiod));
   if(printout) {char tmp1[21]; sprintf(tmp1, "%ld", getStep()); csfile = string("cs")+getLabel()+"-"+tmp1+string(".dat");}
 
-  double fact=1.0;
   if(!ensemble) { 
      energy = meth_list[0]->calc_cs_force(coor, forces);
      if(printout) meth_list[0]->write_cs(csfile.c_str());
+     finishCalculation();
   } else {
      meth_list[0]->calc_cs(coor);
      if(printout) meth_list[0]->write_cs(csfile.c_str());
@@ -325,16 +327,24 @@ void CH3Shifts::calculate()
      for(unsigned j=0;j<size;j++) sh[6][j] = meth_list[0]->val_calc_hg1[j];
      size = meth_list[0]->val_calc_hg2.size();
      for(unsigned j=0;j<size;j++) sh[7][j] = meth_list[0]->val_calc_hg2[j];
+     // the shifts of all the actions are averaged over the replicas together
+     addToEnsembleAverage(&sh[0][0], numResidues*8);
+     doSums();
+  }
+}
+
+void CH3Shifts::finishCalculation()
+{
+  Tensor virial;
+  virial.zero();
+  vector<Vector> deriv(getNumberOfAtoms());
+  int N = getNumberOfAtoms();
+
+  double fact=1.0;
+  if(ensemble) {
      fact = 1./((double) ens_dim);
-     if(comm.Get_rank()==0) { // I am the master of my replica
-       // among replicas
-       multi_sim_comm.Sum(&sh[0][0], numResidues*8);
-       for(unsigned i=0;i<8;i++) for(int j=0;j<numResidues;j++) sh[j][i] *= fact; 
-     } else for(unsigned i=0;i<8;i++) for(int j=0;j<numResidues;j++) sh[j][i] = 0.;
-     // inside each replica
-     comm.Sum(&sh[0][0], numResidues*8);
      // now send the averaged shifts back to almost
-     size = meth_list[0]->ala_calc_hb.size();
+     unsigned size = meth_list[0]->ala_calc_hb.size();
      for(unsigned j=0;j<size;j++)  meth_list[0]->ala_calc_hb[j] = sh[0][j];
      size = meth_list[0]->ile_calc_hd.size();
      for(unsigned j=0;j<size;j++) meth_list[0]->ile_calc_hd[j] = sh[1][j];
@@ -139,6 +139,7 @@ public:
   ~CS2Backbone();
   static void registerKeywords( Keywords& keys );
   virtual void calculate();
+  virtual void finishCalculation();
 };
 
 PLUMED_REGISTER_ACTION(CS2Backbone,"CS2BACKBONE")
@@ -361,17 +362,18 @@ void CS2Backbone::calculate()
     cam_list[0].printout_chemical_shifts(csfile.c_str(), sh);
   }
 
-  double fact=1.0;
   if(ensemble) {
-    fact = 1./((double) ens_dim);
-    if(comm.Get_rank()==0) { // I am the master of my replica
-      // among replicas
-      multi_sim_comm.Sum(&sh[0][0], numResidues*6);
-      for(unsigned i=0;i<6;i++) for(unsigned j=0;j<numResidues;j++) sh[j][i] *= fact; 
-    } else for(unsigned i=0;i<6;i++) for(unsigned j=0;j<numResidues;j++) sh[j][i] = 0.;
-    // inside each replica
-    comm.Sum(&sh[0][0], numResidues*6);
-  }
+    // the shifts of all the actions are averaged over the replicas together
+    addToEnsembleAverage(&sh[0][0], numResidues*6);
+    doSums();
+  } else finishCalculation();
+}
+
+void CS2Backbone::finishCalculation()
+{
+  unsigned N = getNumberOfAtoms();
+  double fact=1.0;
+  if(ensemble) fact = 1./((double) ens_dim);
 
   csforces.clear();
   double energy = cam_list[0].ens_energy_force(coor, csforces, sh);
@@ -23,6 +23,7 @@
 #include "tools/NeighborList.h"
 #include "ActionRegister.h"
 #include "tools/SwitchingFunction.h"
+#include "tools/OpenMP.h"
 
 #include <string>
 #include <cmath>
@@ -79,12 +80,20 @@ private:
   NeighborList *nl;
   std::vector<SwitchingFunction> sfs;
   vector<double> reference, weight;
+/// The value, derivatives and virial, which are kept until the sums over the processes are done
+  double ncoord;
+  std::vector<Vector> deriv;
+  Tensor virial;
+/// Per-thread derivatives and virial, allocated once
+  OpenMPBuffers<Vector> derivBuffers;
+  OpenMPBuffers<Tensor> virialBuffers;
 public:
   static void registerKeywords( Keywords& keys );
   ContactMap(const ActionOptions&);
   ~ContactMap();
 // active methods:
   virtual void calculate();
+  void finishCalculation();
   void checkFieldsAllowed(){}
 };
 
@@ -234,9 +243,8 @@ ContactMap::~ContactMap(){
 
 void ContactMap::calculate(){ 
      
- double ncoord=0., coord;
- Tensor virial;
- std::vector<Vector> deriv(getNumberOfAtoms());
+ virial.zero();
+ deriv.assign(getNumberOfAtoms(),Vector());
 
  unsigned stride=comm.Get_size();
  unsigned rank=comm.Get_rank();
@@ -249,8 +257,25 @@ void ContactMap::calculate(){
    rank=comm.Get_rank();
  }
 
+ unsigned nt=OpenMP::getNumThreads();
+ const unsigned nn=nl->size();
+ if(nt*stride*10>nn) nt=nn/stride/10;
+ // components are set pair by pair, so threads are only used for the sum
+ if(nt==0 || docomp) nt=1;
+ if(nt>1){
+   derivBuffers.resize(nt,deriv.size());
+   virialBuffers.resize(nt,1);
+ }
+
+ double sum=0.;
+#pragma omp parallel num_threads(nt)
+{
+ std::vector<Vector> & omp_deriv(nt>1?derivBuffers.getThreadBuffer():deriv);
+ Tensor & omp_virial(nt>1?virialBuffers.getThreadBuffer()[0]:virial);
+
  // sum over close pairs
- for(unsigned i=rank;i<nl->size();i+=stride) {
+#pragma omp for reduction(+:sum)
+ for(unsigned i=rank;i<nn;i+=stride) {
     Vector distance;
     unsigned i0=nl->getClosePair(i).first;
     unsigned i1=nl->getClosePair(i).second;
@@ -261,21 +286,21 @@ void ContactMap::calculate(){
     }
 
     double dfunc=0.;
-    coord = weight[i]*(sfs[i].calculate(distance.modulo(), dfunc) - reference[i]);
+    double coord = weight[i]*(sfs[i].calculate(distance.modulo(), dfunc) - reference[i]);
     Vector tmpder = weight[i]*dfunc*distance;
     Tensor tmpvir = weight[i]*dfunc*Tensor(distance,distance);
     if(!docmdist) { 
-       deriv[i0] -= tmpder;
-       deriv[i1] += tmpder;
-       virial    -= tmpvir;
-       ncoord    += coord;
+       omp_deriv[i0] -= tmpder;
+       omp_deriv[i1] += tmpder;
+       omp_virial    -= tmpvir;
+       sum           += coord;
     } else {
        tmpder *= 2.*coord;
        tmpvir *= 2.*coord;
-       deriv[i0] -= tmpder;
-       deriv[i1] += tmpder;
-       virial    -= tmpvir;
-       ncoord    += coord*coord;
+       omp_deriv[i0] -= tmpder;
+       omp_deriv[i1] += tmpder;
+       omp_virial    -= tmpvir;
+       sum           += coord*coord;
     }
 
     if(docomp) {
@@ -286,13 +311,22 @@ void ContactMap::calculate(){
        val->set(coord);
     }
  }
+ if(nt>1){
+   derivBuffers.reduce(deriv);
+   virialBuffers.reduce(virial);
+ }
+}
+ ncoord=sum;
 
  if(!serial){
-   comm.Sum(&ncoord,1);
-   if(!deriv.empty()) comm.Sum(&deriv[0][0],3*deriv.size());
-   comm.Sum(&virial[0][0],9);
+   addToSum(ncoord);
+   addToSum(deriv);
+   addToSum(virial);
  }
+ doSums();
+}
 
+void ContactMap::finishCalculation(){
  if( !docomp ){
    for(unsigned i=0;i<deriv.size();++i) setAtomsDerivatives(i,deriv[i]);
    setValue           (ncoord);
@@ -132,9 +132,8 @@ void CoordinationBase::calculate()
 {
 
  double ncoord=0.;
- Tensor virial;
- vector<Vector> deriv(getNumberOfAtoms());
-// deriv.resize(getPositions().size());
+ virial.zero();
+ deriv.assign(getNumberOfAtoms(),Vector());
 
  if(nl->getStride()>0 && invalidateList){
    nl->update(getPositions());
@@ -157,12 +156,17 @@ const unsigned nn=nl->size();
 if(nt*stride*10>nn) nt=nn/stride/10;
 if(nt==0)nt=1;
 
+if(nt>1){
+  derivBuffers.resize(nt,deriv.size());
+  virialBuffers.resize(nt,1);
+}
+
 #pragma omp parallel num_threads(nt)
 {
- std::vector<Vector> omp_deriv(getPositions().size());
- Tensor omp_virial;
+ std::vector<Vector> & omp_deriv(nt>1?derivBuffers.getThreadBuffer():deriv);
+ Tensor & omp_virial(nt>1?virialBuffers.getThreadBuffer()[0]:virial);
 
-#pragma omp for reduction(+:ncoord) nowait
+#pragma omp for reduction(+:ncoord)
  for(unsigned int i=rank;i<nn;i+=stride) {   
  
   Vector distance;
@@ -182,34 +186,30 @@ if(nt==0)nt=1;
 
   Vector dd(dfunc*distance);
   Tensor vv(dd,distance);
-  if(nt>1){
-    omp_deriv[i0]-=dd;
-    omp_deriv[i1]+=dd;
-    omp_virial-=vv;
-  } else {
-    deriv[i0]-=dd;
-    deriv[i1]+=dd;
-    virial-=vv;
-  }
+  omp_deriv[i0]-=dd;
+  omp_deriv[i1]+=dd;
+  omp_virial-=vv;
 
  }
-#pragma omp critical
  if(nt>1){
-  for(int i=0;i<getPositions().size();i++) deriv[i]+=omp_deriv[i];
-  virial+=omp_virial;
+  derivBuffers.reduce(deriv);
+  virialBuffers.reduce(virial);
  }
 }
 
+ coordination=ncoord;
  if(!serial){
-   comm.Sum(ncoord);
-   if(!deriv.empty()) comm.Sum(&deriv[0][0],3*deriv.size());
-   comm.Sum(virial);
+   addToSum(coordination);
+   addToSum(deriv);
+   addToSum(virial);
  }
+ doSums();
+}
 
+void CoordinationBase::finishCalculation(){
  for(unsigned i=0;i<deriv.size();++i) setAtomsDerivatives(i,deriv[i]);
- setValue           (ncoord);
+ setValue           (coordination);
  setBoxDerivatives  (virial);
-
 }
 }
 }
@@ -22,6 +22,7 @@
 #ifndef __PLUMED_colvar_CoordinationBase_h
 #define __PLUMED_colvar_CoordinationBase_h
 #include "Colvar.h"
+#include "tools/OpenMP.h"
 
 namespace PLMD{
 
@@ -35,12 +36,20 @@ class CoordinationBase : public Colvar {
   NeighborList *nl;
   bool invalidateList;
   bool firsttime;
+/// The value, derivatives and virial, which are kept until the sums over the processes are done
+  double coordination;
+  std::vector<Vector> deriv;
+  Tensor virial;
+/// Per-thread derivatives and virial, allocated once
+  OpenMPBuffers<Vector> derivBuffers;
+  OpenMPBuffers<Tensor> virialBuffers;
   
 public:
   CoordinationBase(const ActionOptions&);
   ~CoordinationBase();
 // active methods:
   virtual void calculate();
+  void finishCalculation();
   virtual void prepare();
   virtual double pairing(double distance,double&dfunc,unsigned i,unsigned j)const=0;
   static void registerKeywords( Keywords& keys );
@@ -78,11 +78,17 @@ private:
   bool             isupper;
   bool             ensemble;
   bool             serial;
+  // quantities that are kept between calculate() and finishCalculation()
+  vector<double>   noe;
+  vector<double>   dnoe;
+  vector<Vector>   deriv;
+  double           score;
 public:
   static void registerKeywords( Keywords& keys );
   NOE(const ActionOptions&);
   ~NOE();
   virtual void calculate();
+  virtual void finishCalculation();
 };
 
 PLUMED_REGISTER_ACTION(NOE,"NOE")
@@ -196,12 +202,11 @@ NOE::~NOE(){
 } 
 
 void NOE::calculate(){ 
-  Tensor virial;
-  double score=0.;
-  std::vector<Vector> deriv(getNumberOfAtoms());
+  score=0.;
+  deriv.assign(getNumberOfAtoms(),Vector(0.,0.,0.));
   unsigned sga = nga.size();
-  vector<double> noe(sga);
-  vector<double> dnoe(sga);
+  noe.resize(sga);
+  dnoe.resize(sga);
  
   // internal parallelisation
   unsigned stride=comm.Get_size();
@@ -268,19 +273,28 @@ void NOE::calculate(){
   }
 
   // Ensemble averaging
+  if(ensemble) {
+    // share the calculated noe unless they have been already shared by printout
+    if(!serial&&!printout) addToSum(&noe[0],noe.size());
+    // the noe of all the actions are averaged over the replicas together
+    addToEnsembleAverage(noe);
+    doSums();
+  } else finishCalculation();
+}
+
+void NOE::finishCalculation(){
+  Tensor virial;
+  unsigned sga = nga.size();
+  unsigned stride=comm.Get_size();
+  unsigned rank=comm.Get_rank();
+  if(serial){
+    stride=1;
+    rank=0;
+  }
+
   double fact=1.0;
   if(ensemble) {
     fact = 1./((double) ens_dim);
-    // share the calculated noe unless they have been already shared by printout
-    if(!serial&&!printout) comm.Sum(&noe[0],noe.size());
-    // I am the master of my replica
-    if(comm.Get_rank()==0) {
-      // among replicas
-      multi_sim_comm.Sum(&noe[0], sga );
-      for(unsigned i=0;i<sga;i++) noe[i] *= fact; 
-    } else for(unsigned i=0;i<sga;i++) noe[i] = 0.;
-    // inside each replica
-    comm.Sum(&noe[0], sga );
     for(unsigned i=rank;i<sga;i+=stride) {
       double diff = pow(noe[i],(-1./6.)) - noedist[i];
       bool doscore = (isupper&&diff>0.) || (!isupper); 
@@ -291,7 +305,7 @@ void NOE::calculate(){
     }
   }
 
-  index=0; for(unsigned k=0;k<rank;k++) index += nga[k];
+  unsigned index=0; for(unsigned k=0;k<rank;k++) index += nga[k];
 
   for(unsigned i=rank;i<sga;i+=stride) { //cycle over the number of groups
     for(unsigned j=0;j<nga[i];j++) {
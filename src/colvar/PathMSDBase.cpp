@@ -137,8 +137,9 @@ void PathMSDBase::calculate(){
     for(unsigned j=0;j<nat;j++) tmp_derivs2[i*nat+j]=tmp_derivs[j];
   }
 // reduce over all processors
-  comm.Sum(tmp_distances);
-  comm.Sum(tmp_derivs2);
+  Communicator::Request rdist=comm.Isum(tmp_distances);
+  Communicator::Request rder=comm.Isum(tmp_derivs2);
+  rdist.wait(); rder.wait();
 // assign imgVec[i].distance and imgVec[i].distder
   for(unsigned i=0;i<imgVec.size();i++){
     imgVec[i].distance=tmp_distances[i];
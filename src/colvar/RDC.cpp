@@ -128,10 +128,16 @@ private:
   bool correlation;
   bool serial;
   bool svd;
+  // quantities that are kept between calculate() and finishCalculation()
+  vector<double> rdc;
+  vector<Vector> dRDC;
+  double score;
+  double scx, scx2, scy, scxy;
 public:
   RDC(const ActionOptions&);
   static void registerKeywords( Keywords& keys );
   virtual void calculate();
+  virtual void finishCalculation();
 };
 
 PLUMED_REGISTER_ACTION(RDC,"RDC")
@@ -268,11 +274,11 @@ firstTime(true)
 
 void RDC::calculate()
 {
-  double score=0.;
-  double scx=0., scx2=0., scy=0., scxy=0.;
-  vector<double> rdc( coupl.size() );
+  score=0.;
+  scx=0.; scx2=0.; scy=0.; scxy=0.;
   unsigned N = getNumberOfAtoms();
-  vector<Vector> dRDC(N);
+  rdc.assign(coupl.size(),0.);
+  dRDC.assign(N,Vector(0.,0.,0.));
 
   // internal parallelisation
   unsigned stride=2*comm.Get_size();
@@ -464,19 +470,28 @@ void RDC::calculate()
   }
 
   // Ensemble averaging
+  if(ensemble) {
+    // share the calculated rdc unless they have been already shared by printout
+    if(!serial&&!printout) addToSum(&rdc[0],rdc.size());
+    // the rdc of all the actions are averaged over the replicas together
+    addToEnsembleAverage(rdc);
+    doSums();
+  } else finishCalculation();
+}
+
+void RDC::finishCalculation()
+{
+  unsigned N = getNumberOfAtoms();
+  unsigned stride=2*comm.Get_size();
+  unsigned rank=2*comm.Get_rank();
+  if(serial){
+    stride=2;
+    rank=0;
+  }
+
   double fact=1.0;
   if(ensemble) {
     fact = 1./((double) ens_dim);
-    // share the calculated rdc unless they have been already shared by printout
-    if(!serial&&!printout) comm.Sum(&rdc[0],rdc.size());
-    // I am the master of my replica
-    if(comm.Get_rank()==0) {
-      // among replicas
-      multi_sim_comm.Sum(&rdc[0], coupl.size() );
-      for(unsigned i=0;i<coupl.size();i++) rdc[i] *= fact; 
-    } else for(unsigned i=0;i<coupl.size();i++) rdc[i] = 0.;
-    // inside each replica
-    comm.Sum(&rdc[0], coupl.size() );
     score = 0.;
     for(unsigned r=rank;r<N;r+=stride) {
       unsigned index=r/2;
@@ -24,6 +24,7 @@
 #include "PlumedMain.h"
 #include "tools/Log.h"
 #include "tools/Exception.h"
+#include "tools/Communicator.h"
 #include "Atoms.h"
 #include "ActionSet.h"
 #include <iostream>
@@ -61,6 +62,8 @@ Action::Action(const ActionOptions&ao):
   update_until(std::numeric_limits<double>::max()),
   active(false),
   restart(ao.plumed.getRestart()),
+  sumsPending(false),
+  ensembleUsed(false),
   plumed(ao.plumed),
   log(plumed.getLog()),
   comm(plumed.comm),
@@ -143,15 +146,17 @@ void Action::addDependency(Action*action){
 }
 
 void Action::activate(){
+// an Action that is already active has already activated its dependencies at this step.
+// returning here ensures each Action is visited once per step, also when its value
+// is used by many other Actions
+  if(active) return;
 // preparation step is called only the first time an Action is activated.
 // since it could change its dependences (e.g. in an ActionAtomistic which is
 // accessing to a virtual atom), this is done just before dependencies are
 // activated
-  if(!active){
-    this->unlockRequests();
-    prepare();
-    this->lockRequests();
-  }
+  this->unlockRequests();
+  prepare();
+  this->lockRequests();
   for(Dependencies::iterator p=after.begin();p!=after.end();++p) (*p)->activate();
   active=true;
 }
@@ -247,6 +252,107 @@ bool Action::checkUpdate()const{
   else return false;
 }
 
+void Action::addToSum(double*buf,unsigned n){
+  if(n>0) sumBuffers.push_back(std::pair<double*,unsigned>(buf,n));
+}
+
+void Action::addToSum(double&buf){
+  addToSum(&buf,1);
+}
+
+void Action::addToSum(Tensor&buf){
+  addToSum(&buf[0][0],9);
+}
+
+void Action::addToSum(std::vector<Vector>&buf){
+  if(!buf.empty()) addToSum(&buf[0][0],3*buf.size());
+}
+
+void Action::addToEnsembleAverage(double*buf,unsigned n){
+  ensembleUsed=true;
+  if(n>0) ensembleBuffers.push_back(std::pair<double*,unsigned>(buf,n));
+}
+
+void Action::addToEnsembleAverage(double&buf){
+  addToEnsembleAverage(&buf,1);
+}
+
+void Action::addToEnsembleAverage(std::vector<double>&buf){
+  if(!buf.empty()) addToEnsembleAverage(&buf[0],buf.size());
+}
+
+void Action::doSums(){
+  if(ensembleBuffers.empty() && (comm.Get_size()==1 || sumBuffers.empty())){
+    sumBuffers.clear();
+    finishCalculation();
+  } else if(plumed.canDelaySums(this)){
+    sumsPending=true;
+  } else {
+// the buffers are packed so that there is a single call to comm.Sum also when the sum is not delayed
+    if(comm.Get_size()>1 && !sumBuffers.empty()){
+      std::vector<double> packed(getSizeOfSums());
+      packSums(&packed[0]);
+      comm.Sum(packed);
+      unpackSums(&packed[0]);
+    }
+    sumBuffers.clear();
+    if(!ensembleBuffers.empty()){
+      std::vector<double> packed(getSizeOfEnsembleAverages());
+      packEnsembleAverages(&packed[0]);
+      plumed.averageOverReplicas(packed);
+      unpackEnsembleAverages(&packed[0]);
+    }
+    finishSums();
+  }
+}
+
+unsigned Action::getSizeOfSums()const{
+  unsigned n=0;
+  for(unsigned i=0;i<sumBuffers.size();++i) n+=sumBuffers[i].second;
+  return n;
+}
+
+void Action::packSums(double*packed)const{
+  for(unsigned i=0;i<sumBuffers.size();++i){
+    for(unsigned j=0;j<sumBuffers[i].second;++j) packed[j]=sumBuffers[i].first[j];
+    packed+=sumBuffers[i].second;
+  }
+}
+
+void Action::unpackSums(const double*packed){
+  for(unsigned i=0;i<sumBuffers.size();++i){
+    for(unsigned j=0;j<sumBuffers[i].second;++j) sumBuffers[i].first[j]=packed[j];
+    packed+=sumBuffers[i].second;
+  }
+  sumBuffers.clear();
+}
+
+unsigned Action::getSizeOfEnsembleAverages()const{
+  unsigned n=0;
+  for(unsigned i=0;i<ensembleBuffers.size();++i) n+=ensembleBuffers[i].second;
+  return n;
+}
+
+void Action::packEnsembleAverages(double*packed)const{
+  for(unsigned i=0;i<ensembleBuffers.size();++i){
+    for(unsigned j=0;j<ensembleBuffers[i].second;++j) packed[j]=ensembleBuffers[i].first[j];
+    packed+=ensembleBuffers[i].second;
+  }
+}
+
+void Action::unpackEnsembleAverages(const double*packed){
+  for(unsigned i=0;i<ensembleBuffers.size();++i){
+    for(unsigned j=0;j<ensembleBuffers[i].second;++j) ensembleBuffers[i].first[j]=packed[j];
+    packed+=ensembleBuffers[i].second;
+  }
+  ensembleBuffers.clear();
+}
+
+void Action::finishSums(){
+  sumsPending=false;
+  finishCalculation();
+}
+
 
 }
 
@@ -28,6 +28,7 @@
 #include "Value.h"
 #include "tools/Tools.h"
 #include "tools/Log.h"
+#include "tools/Tensor.h"
 
 namespace PLMD{
 
@@ -97,6 +98,18 @@ private:
 
   bool restart;
 
+/// The buffers that have to be summed over the processes before finishCalculation() is called
+  std::vector< std::pair<double*,unsigned> > sumBuffers;
+
+/// The buffers that have to be averaged over the replicas before finishCalculation() is called
+  std::vector< std::pair<double*,unsigned> > ensembleBuffers;
+
+/// True if the sums have been left to PlumedMain so finishCalculation() has not been called yet
+  bool sumsPending;
+
+/// True if this action has ever asked for an average over the replicas
+  bool ensembleUsed;
+
 public:
 
 /// Reference to main plumed object
@@ -245,6 +258,15 @@ public:
 /// Check if the action needs gradient
   virtual bool checkNeedsGradients()const{return false;}
 
+/// Check if apply() has anything to do at this step.
+/// Actions that only propagate the forces acting on their own output can return false
+/// when there are no such forces, so that they are skipped in the backward loop
+  virtual bool checkNeedsApply()const{return true;}
+
+/// Check if calculate() can change the state of the actions this action depends on.
+/// Such actions are never calculated at the same time as other actions that use the same dependencies
+  virtual bool checkModifiesDependencies()const{return false;}
+
 /// Perform calculation using numerical derivatives
 /// N.B. only pass an ActionWithValue to this routine if you know exactly what you 
 /// are doing.
@@ -270,6 +292,48 @@ public:
 
 /// Cite a paper see PlumedMain::cite
   std::string cite(const std::string&s);
+
+/// Add a buffer that has to be summed over all the processes in comm.
+/// The sum is done when doSums() is called
+  void addToSum(double*buf,unsigned n);
+  void addToSum(double&buf);
+  void addToSum(Tensor&buf);
+  void addToSum(std::vector<Vector>&buf);
+/// Add a buffer that has to be averaged over the replicas of a multiple-replica simulation.
+/// The value of this replica is taken from the first process in comm once the buffers
+/// added with addToSum() have been summed, and the average is then shared with all the processes.
+/// The average is done when doSums() is called
+  void addToEnsembleAverage(double*buf,unsigned n);
+  void addToEnsembleAverage(double&buf);
+  void addToEnsembleAverage(std::vector<double>&buf);
+/// Sum the buffers added with addToSum(), average those added with addToEnsembleAverage()
+/// and then call finishCalculation().
+/// When this is called from calculate() in the forward loop PlumedMain can delay the
+/// sum so that the buffers of many actions are summed with a single call to comm.Sum
+/// and averaged over the replicas with a single nonblocking reduction.
+/// The sums of an action that is calculated by another one (e.g. through a bridge) are never delayed.
+/// Nothing should be done in calculate() after calling this method
+  void doSums();
+/// Complete the calculation once the buffers added with addToSum() have been summed
+  virtual void finishCalculation(){}
+/// Check if the sums of this action have been delayed and finishCalculation() has not been called yet
+  bool checkSumsPending()const{return sumsPending;}
+/// Get the number of elements in the buffers added with addToSum()
+  unsigned getSizeOfSums()const;
+/// Copy the buffers added with addToSum() into a packed array
+  void packSums(double*)const;
+/// Copy the summed buffers back from a packed array
+  void unpackSums(const double*);
+/// Check if this action has ever asked for an average over the replicas
+  bool checkEnsembleUsed()const{return ensembleUsed;}
+/// Get the number of elements in the buffers added with addToEnsembleAverage()
+  unsigned getSizeOfEnsembleAverages()const;
+/// Copy the buffers added with addToEnsembleAverage() into a packed array
+  void packEnsembleAverages(double*)const;
+/// Copy the averaged buffers back from a packed array
+  void unpackEnsembleAverages(const double*);
+/// Call finishCalculation() once all the buffers have been unpacked
+  void finishSums();
 };
 
 /////////////////////
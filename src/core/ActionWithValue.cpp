@@ -67,6 +67,11 @@ ActionWithValue::~ActionWithValue(){
 void ActionWithValue::clearInputForces(){
   for(unsigned i=0;i<values.size();i++) values[i]->clearInputForce();
 }
+
+bool ActionWithValue::checkForForces()const{
+  for(unsigned i=0;i<values.size();i++) if(values[i]->hasForce) return true;
+  return false;
+}
 void ActionWithValue::clearDerivatives(){
   for(unsigned i=0;i<values.size();i++) values[i]->clearDerivatives();
 } 
@@ -152,6 +152,8 @@ public:
   int getNumberOfComponents() const ;
 /// Clear the forces on the values
   void clearInputForces();
+/// Check if there is a force acting on any of the values
+  bool checkForForces()const;
 /// Clear the derivatives of values wrt parameters
   virtual void clearDerivatives();
 /// Calculate the gradients and store them for all the values (need for projections) 
@@ -44,6 +44,11 @@ ActionWithVirtualAtom::~ActionWithVirtualAtom(){
   atoms.removeVirtualAtom(this);
 }
 
+bool ActionWithVirtualAtom::checkNeedsApply()const{
+// forces on virtual atoms are set to zero at every step before the backward loop
+  return modulo2(atoms.forces[index.index()])>0.0;
+}
+
 void ActionWithVirtualAtom::apply(){
   const Vector & f(atoms.forces[index.index()]);
   for(unsigned i=0;i<getNumberOfAtoms();i++) modifyForces()[i]=matmul(derivatives[i],f);
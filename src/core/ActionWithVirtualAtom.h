@@ -64,6 +64,8 @@ public:
   ~ActionWithVirtualAtom();
   static void registerKeywords(Keywords& keys);
   void setGradientsIfNeeded();
+/// Forces on the atoms only come from the force on the virtual atom
+  bool checkNeedsApply()const;
 };
 
 inline
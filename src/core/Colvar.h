@@ -66,6 +66,8 @@ protected:
   void           setBoxDerivativesNoPbc(Value*);
 public:
   bool checkIsEnergy(){return isEnergy;}
+/// Forces on the atoms only come from forces on the components
+  bool checkNeedsApply()const{return checkForForces();}
   Colvar(const ActionOptions&);
   ~Colvar(){}
   static void registerKeywords( Keywords& keys );
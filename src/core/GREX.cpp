@@ -40,7 +40,10 @@ GREX::GREX(PlumedMain&p):
   foreignDeltaBias(0),
   localUNow(0),
   localUSwap(0),
-  myreplica(-1) // = unset
+  myreplica(-1), // = unset
+  partnerSet(false),
+  positionsSaved(false),
+  exchangeStarted(false)
 {
   p.setSuffix(".NA");
 }
@@ -89,7 +92,10 @@ void GREX::cmd(const string&key,void*val){
     calculate();
   }else if(key=="setPartner"){
     CHECK_INIT(initialized,key);
+    discardExchange();
     partner=*static_cast<int*>(val);
+    partnerSet=true;
+    startExchange();
   }else if(key=="savePositions"){
     CHECK_INIT(initialized,key);
     savePositions();
@@ -108,15 +114,14 @@ void GREX::cmd(const string&key,void*val){
     CHECK_NULL(val,key);
     double x;
     atoms.MD2double(val,x);
+// the sum over intracomm is done in calculate(), together with localUSwap
     localUNow=x*(atoms.getMDUnits().getEnergy()/atoms.getUnits().getEnergy());
-    intracomm.Sum(localUNow);
   }else if(key=="cacheLocalUSwap"){
     CHECK_INIT(initialized,key);
     CHECK_NULL(val,key);
     double x;
     atoms.MD2double(val,x);
     localUSwap=x*(atoms.getMDUnits().getEnergy()/atoms.getUnits().getEnergy());
-    intracomm.Sum(localUSwap);
   }else if(key=="getForeignDeltaBias"){
     CHECK_INIT(initialized,key);
     CHECK_NULL(val,key);
@@ -125,9 +130,8 @@ void GREX::cmd(const string&key,void*val){
   }else if(key=="shareAllDeltaBias"){
     CHECK_INIT(initialized,key);
     if(intracomm.Get_rank()!=0) return;
-    allDeltaBias.assign(intercomm.Get_size(),0.0);
-    allDeltaBias[intercomm.Get_rank()]=localDeltaBias;
-    intercomm.Sum(allDeltaBias);
+    allDeltaBias.resize(intercomm.Get_size());
+    intercomm.Allgather(localDeltaBias,allDeltaBias);
   }else{
 // multi word commands
      std::vector<std::string> words=Tools::getWords(key);
@@ -150,6 +154,7 @@ void GREX::cmd(const string&key,void*val){
 }
 
 void GREX::savePositions(){
+  discardExchange();
   plumedMain.prepareDependencies();
   plumedMain.resetActive(true);
   atoms.shareAll();
@@ -157,31 +162,55 @@ void GREX::savePositions(){
   ostringstream o;
   atoms.writeBinary(o);
   buffer=o.str();
+  positionsSaved=true;
+  startExchange();
+}
+
+void GREX::startExchange(){
+  if(exchangeStarted || !partnerSet || !positionsSaved) return;
+  if(intracomm.Get_rank()!=0) return;
+  rbuffer.resize(buffer.size());
+  recvRequest=intercomm.Irecv(rbuffer,partner,1066);
+  sendRequest=intercomm.Isend(buffer,partner,1066);
+  exchangeStarted=true;
+}
+
+void GREX::discardExchange(){
+  if(!exchangeStarted) return;
+// the partner has started the matching exchange, so waiting does not block
+  recvRequest.wait();
+  sendRequest.wait();
+  partnerSet=positionsSaved=exchangeStarted=false;
 }
 
 void GREX::calculate(){
 //fprintf(stderr,"CALCULATE %d %d\n",intercomm.Get_rank(),partner);
-  unsigned nn=buffer.size();
-  vector<char> rbuf(nn);
+  rbuffer.resize(buffer.size());
   localDeltaBias=-plumedMain.getBias();
   if(intracomm.Get_rank()==0){
-    Communicator::Request req=intercomm.Isend(buffer,partner,1066);
-    intercomm.Recv(rbuf,partner,1066);
-    req.wait();
+// the exchange is started here if the partner was set once and for all or the positions were not saved
+    partnerSet=positionsSaved=true;
+    startExchange();
+    recvRequest.wait();
+    sendRequest.wait();
   }
-  intracomm.Bcast(rbuf,0);
-  istringstream i(string(&rbuf[0],rbuf.size()));
+  partnerSet=positionsSaved=exchangeStarted=false;
+  intracomm.Bcast(rbuffer,0);
+  istringstream i(string(&rbuffer[0],rbuffer.size()));
   atoms.readBinary(i);
   plumedMain.setExchangeStep(true);
   plumedMain.prepareDependencies();
   plumedMain.justCalculate();
   plumedMain.setExchangeStep(false);
   localDeltaBias+=plumedMain.getBias();
-  localDeltaBias+=localUSwap-localUNow;
+  double u[2]={localUNow,localUSwap};
+  intracomm.Sum(u,2);
+  localDeltaBias+=u[1]-u[0];
   if(intracomm.Get_rank()==0){
-    Communicator::Request req=intercomm.Isend(localDeltaBias,partner,1067);
-    intercomm.Recv(foreignDeltaBias,partner,1067);
-    req.wait();
+    Communicator::Request rreq=intercomm.Irecv(foreignDeltaBias,partner,1067);
+    Communicator::Request sreq=intercomm.Isend(localDeltaBias,partner,1067);
+    rreq.wait();
+    sreq.wait();
 //fprintf(stderr,">>> %d %d %20.12f %20.12f %20.12f %20.12f\n",intercomm.Get_rank(),partner,localDeltaBias,foreignDeltaBias,localUSwap,localUNow);
   }
   intracomm.Bcast(foreignDeltaBias,0);
@@ -23,6 +23,7 @@
 #define __PLUMED_core_GREX_h
 
 #include "WithCmd.h"
+#include "tools/Communicator.h"
 #include <string>
 #include <vector>
 
@@ -30,7 +31,6 @@ namespace PLMD{
 
 class PlumedMain;
 class Atoms;
-class Communicator;
 
 class GREX:
   public WithCmd
@@ -47,7 +47,23 @@ class GREX:
   double localUSwap;
   std::vector<double> allDeltaBias;
   std::string buffer;
+  std::vector<char> rbuffer;
   int myreplica;
+/// True if the partner has been set since the last exchange
+  bool partnerSet;
+/// True if the positions have been saved since the last exchange
+  bool positionsSaved;
+/// True if the nonblocking exchange of the positions has been started
+  bool exchangeStarted;
+  Communicator::Request sendRequest;
+  Communicator::Request recvRequest;
+/// Start the nonblocking exchange of the positions with the partner.
+/// This is done as soon as both the partner and the positions are known,
+/// so that the messages travel while the MD code does its own exchange logic
+  void startExchange();
+/// Complete and discard an exchange that was started but not used by calculate(),
+/// e.g. because the MD code saved the positions and then skipped the exchange
+  void discardExchange();
 public:
   GREX(PlumedMain&);
   ~GREX();
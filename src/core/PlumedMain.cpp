@@ -47,7 +47,19 @@
 
 using namespace std;
 
-enum { SETBOX, SETPOSITIONS, SETMASSES, SETCHARGES, SETPOSITIONSX, SETPOSITIONSY, SETPOSITIONSZ, SETVIRIAL, SETENERGY, SETFORCES, SETFORCESX, SETFORCESY, SETFORCESZ, CALC, PREPAREDEPENDENCIES, SHAREDATA, PREPARECALC, PERFORMCALC, SETSTEP, SETSTEPLONG, SETATOMSNLOCAL, SETATOMSGATINDEX, SETATOMSFGATINDEX, SETATOMSCONTIGUOUS, CREATEFULLLIST, GETFULLLIST, CLEARFULLLIST, READ, CLEAR, GETAPIVERSION, INIT, SETREALPRECISION, SETMDLENGTHUNITS, SETMDENERGYUNITS, SETMDTIMEUNITS, SETNATURALUNITS, SETNOVIRIAL, SETPLUMEDDAT, SETMPICOMM, SETMPIFCOMM, SETMPIMULTISIMCOMM, SETNATOMS, SETTIMESTEP, SETMDENGINE, SETLOG, SETLOGFILE, SETSTOPFLAG, GETEXCHANGESFLAG, SETEXCHANGESSEED, SETNUMBEROFREPLICAS, GETEXCHANGESLIST, RUNFINALJOBS, ISENERGYNEEDED, GETBIAS, SETKBT };
+enum { SETBOX, SETPOSITIONS, SETMASSES, SETCHARGES, SETPOSITIONSX, SETPOSITIONSY, SETPOSITIONSZ, SETVIRIAL, SETENERGY, SETFORCES, SETFORCESX, SETFORCESY, SETFORCESZ, CALC, PREPAREDEPENDENCIES, SHAREDATA, PREPARECALC, PERFORMCALC, SETSTEP, SETSTEPLONG, SETATOMSNLOCAL, SETATOMSGATINDEX, SETATOMSFGATINDEX, SETATOMSCONTIGUOUS, CREATEFULLLIST, GETFULLLIST, CLEARFULLLIST, READ, CLEAR, GETAPIVERSION, INIT, SETREALPRECISION, SETMDLENGTHUNITS, SETMDENERGYUNITS, SETMDTIMEUNITS, SETNATURALUNITS, SETNOVIRIAL, SETPLUMEDDAT, SETMPICOMM, SETMPIFCOMM, SETMPIMULTISIMCOMM, SETNATOMS, SETTIMESTEP, SETMDENGINE, SETLOG, SETLOGFILE, SETSTOPFLAG, GETEXCHANGESFLAG, SETEXCHANGESSEED, SETNUMBEROFREPLICAS, GETEXCHANGESLIST, RUNFINALJOBS, ISENERGYNEEDED, GETBIAS, SETKBT, GETCOMMANDHANDLEFUNCTION, SETNUMOMPTHREADS };
+
+// Indices of the stopwatches that are used at every step.
+// They are registered in this order in the constructor
+enum { TIMER_TOTAL, TIMER_PREPARE, TIMER_SHARE, TIMER_WAIT, TIMER_CALC, TIMER_APPLY, TIMER_UPDATEFORCES, TIMER_UPDATE };
+
+// Same layout as plumed_function_holder in Plumed.h
+typedef struct {
+  void(*p)(void);
+} plumedmain_function_holder;
+
+// Defined in PlumedMainInitializer.cpp
+extern "C" void plumedmain_cmd_handle(void*plumed,int handle,const void*val);
 
 namespace PLMD{
 
@@ -72,13 +84,25 @@ PlumedMain::PlumedMain():
   restart(false),
   stopFlag(NULL),
   stopNow(false),
+  newLevels(true),
+  nActiveSteps(0),
+  delaySums(NULL),
   novirial(false),
-  detailedTimers(false)
+  detailedTimers(false),
+  concurrentActions(false)
 {
   log.link(comm);
   log.setLinePrefix("PLUMED: ");
-  stopwatch.start();
-  stopwatch.pause();
+  plumed_assert(stopwatch.getWatchIndex("")==TIMER_TOTAL);
+  plumed_assert(stopwatch.getWatchIndex("1 Prepare dependencies")==TIMER_PREPARE);
+  plumed_assert(stopwatch.getWatchIndex("2 Sharing data")==TIMER_SHARE);
+  plumed_assert(stopwatch.getWatchIndex("3 Waiting for data")==TIMER_WAIT);
+  plumed_assert(stopwatch.getWatchIndex("4 Calculating (forward loop)")==TIMER_CALC);
+  plumed_assert(stopwatch.getWatchIndex("5 Applying (backward loop)")==TIMER_APPLY);
+  plumed_assert(stopwatch.getWatchIndex("5B Update forces")==TIMER_UPDATEFORCES);
+  plumed_assert(stopwatch.getWatchIndex("5C Update")==TIMER_UPDATE);
+  stopwatch.start(TIMER_TOTAL);
+  stopwatch.pause(TIMER_TOTAL);
   word_map["setBox"]=SETBOX;
   word_map["setPositions"]=SETPOSITIONS;
   word_map["setMasses"]=SETMASSES;
@@ -134,12 +158,18 @@ PlumedMain::PlumedMain():
   word_map["isEnergyNeeded"]=ISENERGYNEEDED;
   word_map["getBias"]=GETBIAS;
   word_map["setKbT"]=SETKBT;
+  word_map["getCommandHandleFunction"]=GETCOMMANDHANDLEFUNCTION;
+  word_map["setNumOMPthreads"]=SETNUMOMPTHREADS;
+  word_names.resize(word_map.size());
+  for(std::map<std::string,int>::const_iterator it=word_map.begin();it!=word_map.end();++it) word_names[it->second]=it->first;
 }
 
 PlumedMain::~PlumedMain(){
-  stopwatch.start();
-  stopwatch.stop();
+  stopwatch.start(TIMER_TOTAL);
+  stopwatch.stop(TIMER_TOTAL);
   if(initialized) log<<stopwatch;
+  if(initialized && detailedTimers) reportCriticalPath();
+  if(initialized && detailedTimers) reportEvaluations();
   delete &exchangePatterns;
   delete &actionSet;
   delete &citations;
@@ -162,279 +192,28 @@ PlumedMain::~PlumedMain(){
 
 void PlumedMain::cmd(const std::string & word,void*val){
 
-  stopwatch.start();
+// single words are looked up directly, without splitting the string
+  if(word.find_first_of(" \t\n")==std::string::npos){
+    std::map<std::string,int>::const_iterator it=word_map.find(word);
+    if(it!=word_map.end()){
+      cmd(it->second,val);
+      return;
+    }
+  }
+
+  stopwatch.start(TIMER_TOTAL);
 
   std::vector<std::string> words=Tools::getWords(word);
   unsigned nw=words.size();
-  if(nw==1) {
-    switch(word_map[word]) {
-      double d;
-      case SETBOX:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.setBox(val);
-        break;
-      case SETPOSITIONS:
-        CHECK_INIT(initialized,word);
-        atoms.setPositions(val);
-        break;
-      case SETMASSES:
-        CHECK_INIT(initialized,word);
-        atoms.setMasses(val);
-        break;
-      case SETCHARGES:
-        CHECK_INIT(initialized,word);
-        atoms.setCharges(val);
-        break;
-      case SETPOSITIONSX:
-        CHECK_INIT(initialized,word);
-        atoms.setPositions(val,0);
-        break;
-      case SETPOSITIONSY:
-        CHECK_INIT(initialized,word);
-        atoms.setPositions(val,1);
-        break;
-      case SETPOSITIONSZ:
-        CHECK_INIT(initialized,word);
-        atoms.setPositions(val,2);
-        break;
-      case SETVIRIAL:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.setVirial(val);
-        break;
-      case SETENERGY:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.setEnergy(val);
-        break;
-      case SETFORCES:
-        CHECK_INIT(initialized,word);
-        atoms.setForces(val);
-        break;
-      case SETFORCESX:
-        CHECK_INIT(initialized,word);
-        atoms.setForces(val,0);
-        break;
-      case SETFORCESY:
-        CHECK_INIT(initialized,word);
-        atoms.setForces(val,1);
-        break;
-      case SETFORCESZ:
-        CHECK_INIT(initialized,word);
-        atoms.setForces(val,2);
-        break;
-      case CALC:
-        CHECK_INIT(initialized,word);
-        calc();
-        break;
-      case PREPAREDEPENDENCIES:
-        CHECK_INIT(initialized,word);
-        prepareDependencies();
-        break;
-      case SHAREDATA:
-        CHECK_INIT(initialized,word);
-        shareData();
-        break;
-      case PREPARECALC:
-        CHECK_INIT(initialized,word);
-        prepareCalc();
-        break;
-      case PERFORMCALC:
-        CHECK_INIT(initialized,word);
-        performCalc();
-        break;
-      case SETSTEP:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        step=(*static_cast<int*>(val));
-        atoms.startStep();
-        break;
-      case SETSTEPLONG:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        step=(*static_cast<long int*>(val));
-        atoms.startStep();
-        break;
-      // words used less frequently:
-      case SETATOMSNLOCAL:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.setAtomsNlocal(*static_cast<int*>(val));
-        break;
-      case SETATOMSGATINDEX:
-        CHECK_INIT(initialized,word);
-        atoms.setAtomsGatindex(static_cast<int*>(val),false);
-        break;
-      case SETATOMSFGATINDEX:
-        CHECK_INIT(initialized,word);
-        atoms.setAtomsGatindex(static_cast<int*>(val),true);
-        break;
-      case SETATOMSCONTIGUOUS:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.setAtomsContiguous(*static_cast<int*>(val));
-        break;
-      case CREATEFULLLIST:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.createFullList(static_cast<int*>(val));
-        break;
-      case GETFULLLIST:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.getFullList(static_cast<int**>(val));
-        break;
-      case CLEARFULLLIST:
-        CHECK_INIT(initialized,word);
-        atoms.clearFullList();
-        break;
-      case READ:
-        CHECK_INIT(initialized,word);
-        if(val)readInputFile(static_cast<char*>(val));
-        else   readInputFile("plumed.dat");
-        break;
-      case CLEAR:
-        CHECK_INIT(initialized,word);
-        actionSet.clearDelete();
-        break;
-      case GETAPIVERSION:
-        CHECK_NULL(val,word);
-        *(static_cast<int*>(val))=2;
-        break;
-      // commands which can be used only before initialization:
-      case INIT:
-        CHECK_NOTINIT(initialized,word);
-        init();
-        break;
-      case SETREALPRECISION:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.setRealPrecision(*static_cast<int*>(val));
-        break;
-      case SETMDLENGTHUNITS:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.MD2double(val,d);
-        atoms.setMDLengthUnits(d);
-        break;
-      case SETMDENERGYUNITS:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.MD2double(val,d);
-        atoms.setMDEnergyUnits(d);
-        break;
-      case SETMDTIMEUNITS:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.MD2double(val,d);
-        atoms.setMDTimeUnits(d);
-        break;
-      case SETNATURALUNITS:
-      // set the boltzman constant for MD in natural units (kb=1)
-      // only needed in LJ codes if the MD is passing temperatures to plumed (so, not yet...)
-      // use as cmd("setNaturalUnits")
-        CHECK_NOTINIT(initialized,word);
-        atoms.setMDNaturalUnits(true);
-        break;
-      case SETNOVIRIAL:
-        CHECK_NOTINIT(initialized,word);
-        novirial=true;
-        break;
-      case SETPLUMEDDAT:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NULL(val,word);
-        plumedDat=static_cast<char*>(val);
-        break;
-      case SETMPICOMM:
-        CHECK_NOTINIT(initialized,word);
-        comm.Set_comm(val);
-        atoms.setDomainDecomposition(comm);
-        break;
-      case SETMPIFCOMM:
-        CHECK_NOTINIT(initialized,word);
-        comm.Set_fcomm(val);
-        atoms.setDomainDecomposition(comm);
-        break;
-      case SETMPIMULTISIMCOMM:
-        CHECK_NOTINIT(initialized,word);
-        multi_sim_comm.Set_comm(val);
-        break;
-      case SETNATOMS:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.setNatoms(*static_cast<int*>(val));
-        break;
-      case SETTIMESTEP:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.setTimeStep(val);
-        break;
-      case SETKBT: /* ADDED WITH API==2 */
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NULL(val,word);
-        atoms.setKbT(val);
-        break;
-      case SETMDENGINE:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NULL(val,word);
-        MDEngine=static_cast<char*>(val);
-        break;
-      case SETLOG:
-        CHECK_NOTINIT(initialized,word);
-        log.link(static_cast<FILE*>(val));
-        break;
-      case SETLOGFILE:
-        CHECK_NOTINIT(initialized,word);
-        CHECK_NULL(val,word);
-        log.open(static_cast<char*>(val));
-        break;
-      // other commands that should be used after initialization:
-      case SETSTOPFLAG:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        stopFlag=static_cast<int*>(val);
-        break;
-      case GETEXCHANGESFLAG:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        exchangePatterns.getFlag((*static_cast<int*>(val)));
-        break;
-      case SETEXCHANGESSEED:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        exchangePatterns.setSeed((*static_cast<int*>(val)));
-        break;
-      case SETNUMBEROFREPLICAS:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        exchangePatterns.setNofR((*static_cast<int*>(val)));
-        break;
-      case GETEXCHANGESLIST:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        exchangePatterns.getList((static_cast<int*>(val)));
-        break;
-      case RUNFINALJOBS:
-        CHECK_INIT(initialized,word);
-        runJobsAtEndOfCalculation();
-        break;
-      case ISENERGYNEEDED:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        if(atoms.isEnergyNeeded()) *(static_cast<int*>(val))=1;
-        else                       *(static_cast<int*>(val))=0;
-        break;
-      case GETBIAS:
-        CHECK_INIT(initialized,word);
-        CHECK_NULL(val,word);
-        d=getBias()/(atoms.getMDUnits().getEnergy()/atoms.getUnits().getEnergy());
-        atoms.double2MD(d,val);
-        break;
-      default:
-        plumed_merror("cannot interpret cmd(\"" + word + "\"). check plumed developers manual to see the available commands.");
-        break;
-    }
+  if(nw==1 && word_map.count(words[0])) {
+    stopwatch.pause(TIMER_TOTAL);
+    cmd(word_map[words[0]],val);
+    return;
+  } else if(nw==2 && words[0]=="getCommandHandle"){
+    CHECK_NULL(val,word);
+    std::map<std::string,int>::const_iterator it=word_map.find(words[1]);
+    if(it!=word_map.end()) *(static_cast<int*>(val))=it->second;
+    else                   *(static_cast<int*>(val))=-1;
   } else if(nw==2 && words[0]=="checkAction"){
     int check=0;
     if(actionRegister().check(words[1])) check=1;
@@ -454,7 +233,293 @@ void PlumedMain::cmd(const std::string & word,void*val){
   } else{
     plumed_merror("cannot interpret cmd(\"" + word + "\"). check plumed developers manual to see the available commands.");
   };
- stopwatch.pause();
+ stopwatch.pause(TIMER_TOTAL);
+}
+
+void PlumedMain::cmd(int handle,void*val){
+
+  stopwatch.start(TIMER_TOTAL);
+
+  plumed_massert(handle>=0 && handle<int(word_names.size()),"cannot interpret cmd handle. handles should be obtained with cmd(\"getCommandHandle name\")");
+  const std::string & word(word_names[handle]);
+  switch(handle) {
+    double d;
+    case SETBOX:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.setBox(val);
+      break;
+    case SETPOSITIONS:
+      CHECK_INIT(initialized,word);
+      atoms.setPositions(val);
+      break;
+    case SETMASSES:
+      CHECK_INIT(initialized,word);
+      atoms.setMasses(val);
+      break;
+    case SETCHARGES:
+      CHECK_INIT(initialized,word);
+      atoms.setCharges(val);
+      break;
+    case SETPOSITIONSX:
+      CHECK_INIT(initialized,word);
+      atoms.setPositions(val,0);
+      break;
+    case SETPOSITIONSY:
+      CHECK_INIT(initialized,word);
+      atoms.setPositions(val,1);
+      break;
+    case SETPOSITIONSZ:
+      CHECK_INIT(initialized,word);
+      atoms.setPositions(val,2);
+      break;
+    case SETVIRIAL:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.setVirial(val);
+      break;
+    case SETENERGY:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.setEnergy(val);
+      break;
+    case SETFORCES:
+      CHECK_INIT(initialized,word);
+      atoms.setForces(val);
+      break;
+    case SETFORCESX:
+      CHECK_INIT(initialized,word);
+      atoms.setForces(val,0);
+      break;
+    case SETFORCESY:
+      CHECK_INIT(initialized,word);
+      atoms.setForces(val,1);
+      break;
+    case SETFORCESZ:
+      CHECK_INIT(initialized,word);
+      atoms.setForces(val,2);
+      break;
+    case CALC:
+      CHECK_INIT(initialized,word);
+      calc();
+      break;
+    case PREPAREDEPENDENCIES:
+      CHECK_INIT(initialized,word);
+      prepareDependencies();
+      break;
+    case SHAREDATA:
+      CHECK_INIT(initialized,word);
+      shareData();
+      break;
+    case PREPARECALC:
+      CHECK_INIT(initialized,word);
+      prepareCalc();
+      break;
+    case PERFORMCALC:
+      CHECK_INIT(initialized,word);
+      performCalc();
+      break;
+    case SETSTEP:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      step=(*static_cast<int*>(val));
+      atoms.startStep();
+      break;
+    case SETSTEPLONG:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      step=(*static_cast<long int*>(val));
+      atoms.startStep();
+      break;
+    // words used less frequently:
+    case SETATOMSNLOCAL:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.setAtomsNlocal(*static_cast<int*>(val));
+      break;
+    case SETATOMSGATINDEX:
+      CHECK_INIT(initialized,word);
+      atoms.setAtomsGatindex(static_cast<int*>(val),false);
+      break;
+    case SETATOMSFGATINDEX:
+      CHECK_INIT(initialized,word);
+      atoms.setAtomsGatindex(static_cast<int*>(val),true);
+      break;
+    case SETATOMSCONTIGUOUS:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.setAtomsContiguous(*static_cast<int*>(val));
+      break;
+    case CREATEFULLLIST:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.createFullList(static_cast<int*>(val));
+      break;
+    case GETFULLLIST:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.getFullList(static_cast<int**>(val));
+      break;
+    case CLEARFULLLIST:
+      CHECK_INIT(initialized,word);
+      atoms.clearFullList();
+      break;
+    case READ:
+      CHECK_INIT(initialized,word);
+      if(val)readInputFile(static_cast<char*>(val));
+      else   readInputFile("plumed.dat");
+      break;
+    case CLEAR:
+      CHECK_INIT(initialized,word);
+      actionSet.clearDelete();
+      break;
+    case GETAPIVERSION:
+      CHECK_NULL(val,word);
+      *(static_cast<int*>(val))=3;
+      break;
+    case GETCOMMANDHANDLEFUNCTION:
+      CHECK_NULL(val,word);
+      static_cast<plumedmain_function_holder*>(val)->p=reinterpret_cast<void(*)(void)>(plumedmain_cmd_handle);
+      break;
+    // commands which can be used only before initialization:
+    case INIT:
+      CHECK_NOTINIT(initialized,word);
+      init();
+      break;
+    case SETREALPRECISION:
+      CHECK_NOTINIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.setRealPrecision(*static_cast<int*>(val));
+      break;
+    case SETMDLENGTHUNITS:
+      CHECK_NOTINIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.MD2double(val,d);
+      atoms.setMDLengthUnits(d);
+      break;
+    case SETMDENERGYUNITS:
+      CHECK_NOTINIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.MD2double(val,d);
+      atoms.setMDEnergyUnits(d);
+      break;
+    case SETMDTIMEUNITS:
+      CHECK_NOTINIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.MD2double(val,d);
+      atoms.setMDTimeUnits(d);
+      break;
+    case SETNATURALUNITS:
+    // set the boltzman constant for MD in natural units (kb=1)
+    // only needed in LJ codes if the MD is passing temperatures to plumed (so, not yet...)
+    // use as cmd("setNaturalUnits")
+      CHECK_NOTINIT(initialized,word);
+      atoms.setMDNaturalUnits(true);
+      break;
+    case SETNOVIRIAL:
+      CHECK_NOTINIT(initialized,word);
+      novirial=true;
+      break;
+    case SETPLUMEDDAT:
+      CHECK_NOTINIT(initialized,word);
+      CHECK_NULL(val,word);
+      plumedDat=static_cast<char*>(val);
+      break;
+    case SETMPICOMM:
+      CHECK_NOTINIT(initialized,word);
+      comm.Set_comm(val);
+      atoms.setDomainDecomposition(comm);
+      break;
+    case SETMPIFCOMM:
+      CHECK_NOTINIT(initialized,word);
+      comm.Set_fcomm(val);
+      atoms.setDomainDecomposition(comm);
+      break;
+    case SETMPIMULTISIMCOMM:
+      CHECK_NOTINIT(initialized,word);
+      multi_sim_comm.Set_comm(val);
+      break;
+    case SETNATOMS:
+      CHECK_NOTINIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.setNatoms(*static_cast<int*>(val));
+      break;
+    case SETTIMESTEP:
+      CHECK_NOTINIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.setTimeStep(val);
+      break;
+    case SETKBT: /* ADDED WITH API==2 */
+      CHECK_NOTINIT(initialized,word);
+      CHECK_NULL(val,word);
+      atoms.setKbT(val);
+      break;
+    case SETNUMOMPTHREADS: /* ADDED WITH API==3 */
+    // lets the MD engine tell how many threads PLUMED can use without oversubscribing the cores
+      CHECK_NULL(val,word);
+      OpenMP::setNumThreads(*static_cast<int*>(val)>0?*static_cast<int*>(val):1);
+      break;
+    case SETMDENGINE:
+      CHECK_NOTINIT(initialized,word);
+      CHECK_NULL(val,word);
+      MDEngine=static_cast<char*>(val);
+      break;
+    case SETLOG:
+      CHECK_NOTINIT(initialized,word);
+      log.link(static_cast<FILE*>(val));
+      break;
+    case SETLOGFILE:
+      CHECK_NOTINIT(initialized,word);
+      CHECK_NULL(val,word);
+      log.open(static_cast<char*>(val));
+      break;
+    // other commands that should be used after initialization:
+    case SETSTOPFLAG:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      stopFlag=static_cast<int*>(val);
+      break;
+    case GETEXCHANGESFLAG:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      exchangePatterns.getFlag((*static_cast<int*>(val)));
+      break;
+    case SETEXCHANGESSEED:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      exchangePatterns.setSeed((*static_cast<int*>(val)));
+      break;
+    case SETNUMBEROFREPLICAS:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      exchangePatterns.setNofR((*static_cast<int*>(val)));
+      break;
+    case GETEXCHANGESLIST:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      exchangePatterns.getList((static_cast<int*>(val)));
+      break;
+    case RUNFINALJOBS:
+      CHECK_INIT(initialized,word);
+      runJobsAtEndOfCalculation();
+      break;
+    case ISENERGYNEEDED:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      if(atoms.isEnergyNeeded()) *(static_cast<int*>(val))=1;
+      else                       *(static_cast<int*>(val))=0;
+      break;
+    case GETBIAS:
+      CHECK_INIT(initialized,word);
+      CHECK_NULL(val,word);
+      d=getBias()/(atoms.getMDUnits().getEnergy()/atoms.getUnits().getEnergy());
+      atoms.double2MD(d,val);
+      break;
+    default:
+      plumed_merror("cannot interpret cmd(\"" + word + "\"). check plumed developers manual to see the available commands.");
+      break;
+  }
+ stopwatch.pause(TIMER_TOTAL);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -562,7 +627,7 @@ void PlumedMain::prepareCalc(){
 // traverse them in this order:
 void PlumedMain::prepareDependencies(){
 
-  stopwatch.start("1 Prepare dependencies");
+  stopwatch.start(TIMER_PREPARE);
 
 // activate all the actions which are on step
 // activation is recursive and enables also the dependencies
@@ -586,21 +651,51 @@ void PlumedMain::prepareDependencies(){
   };
 
 // also, if one of them is the total energy, tell to atoms that energy should be collected
-  for(ActionSet::iterator p=actionSet.begin();p!=actionSet.end();++p){
-    if((*p)->isActive()){
-      if((*p)->checkNeedsGradients()) (*p)->setOption("GRADIENTS");
+  bool newplan=( planActivity.size()!=actionSet.size() );
+  if(newplan) planActivity.resize(actionSet.size());
+  if(calcCount.size()!=actionSet.size()) calcCount.resize(actionSet.size(),0);
+  if(active) nActiveSteps++;
+  for(unsigned i=0;i<actionSet.size();++i){
+    if(actionSet[i]->isActive()){
+      calcCount[i]++;
+      if(actionSet[i]->checkNeedsGradients()) actionSet[i]->setOption("GRADIENTS");
     }
+    if(planActivity[i]!=actionSet[i]->isActive()){ planActivity[i]=actionSet[i]->isActive(); newplan=true; }
   }
+// the plan for the forward and backward loops only needs to be redone when the active actions change
+  if(newplan) setupPlan();
+
+  stopwatch.stop(TIMER_PREPARE);
+}
 
-  stopwatch.stop("1 Prepare dependencies");
+void PlumedMain::setupPlan(){
+  plan.clear();
+  for(unsigned i=0;i<actionSet.size();++i){
+    if(!actionSet[i]->isActive()) continue;
+    PlanEntry pe; pe.index=i; pe.action=actionSet[i];
+    pe.av=dynamic_cast<ActionWithValue*>(actionSet[i]);
+    pe.aa=dynamic_cast<ActionAtomistic*>(actionSet[i]);
+    pe.avv=dynamic_cast<ActionWithVirtualAtom*>(actionSet[i]);
+    pe.ibias=pe.iwork=-1;
+    if(pe.av){
+      for(int j=0;j<pe.av->getNumberOfComponents();++j){
+        std::string name=pe.av->copyOutput(j)->getName();
+        if(name==pe.action->getLabel()+".bias") pe.ibias=j;
+        if(name==pe.action->getLabel()+".work") pe.iwork=j;
+      }
+    }
+    plan.push_back(pe);
+  }
+// the levels used for the concurrent loops are made from the plan
+  newLevels=true;
 }
 
 void PlumedMain::shareData(){
 // atom positions are shared (but only if there is something to do)
   if(!active)return;
-  stopwatch.start("2 Sharing data");
+  stopwatch.start(TIMER_SHARE);
   if(atoms.getNatoms()>0) atoms.share();
-  stopwatch.stop("2 Sharing data");
+  stopwatch.stop(TIMER_SHARE);
 }
 
 void PlumedMain::performCalc(){
@@ -611,96 +706,413 @@ void PlumedMain::performCalc(){
 
 void PlumedMain::waitData(){
   if(!active)return;
-  stopwatch.start("3 Waiting for data");
+  stopwatch.start(TIMER_WAIT);
   if(atoms.getNatoms()>0) atoms.wait();
-  stopwatch.stop("3 Waiting for data");
+  stopwatch.stop(TIMER_WAIT);
 }
 
 void PlumedMain::justCalculate(){
   if(!active)return;
-  stopwatch.start("4 Calculating (forward loop)");
+  stopwatch.start(TIMER_CALC);
   bias=0.0;
   work=0.0;
+  if(detailedTimers && calcTimers.size()!=actionSet.size()) setupActionTimers();
+
+  if(concurrentActions){
+    justCalculateConcurrently();
+    stopwatch.stop(TIMER_CALC);
+    return;
+  }
 
-  int iaction=0;
 // calculate the active actions in order (assuming *backward* dependence)
-  for(ActionSet::iterator p=actionSet.begin();p!=actionSet.end();++p){
-    std::string actionNumberLabel;
-    if(detailedTimers){
-      Tools::convert(iaction,actionNumberLabel);
-      actionNumberLabel="4A "+actionNumberLabel+" "+(*p)->getLabel();
-      stopwatch.start(actionNumberLabel);
+// inactive actions are not in the plan, so their forces and derivatives are left as they are
+  for(unsigned i=0;i<plan.size();++i){
+    const PlanEntry & pe(plan[i]);
+// the sums that have been delayed are done as late as possible, when an action needs their result
+    if(!pendingSums.empty() || !ensembleSums.empty()){
+      const Action::Dependencies & deps(pe.action->getDependencies());
+      bool needed=false;
+      for(unsigned j=0;j<deps.size();++j) if(deps[j]->checkSumsPending()){ needed=true; break; }
+      if(needed) completeSums();
+// the averages over the replicas are started before an action that does not need them,
+// so that the reduction overlaps with its calculation
+      else if(!pe.action->checkEnsembleUsed()){
+        for(unsigned j=0;j<pendingSums.size();++j) if(plan[pendingSums[j]].action->getSizeOfEnsembleAverages()>0){ startSums(); break; }
+      }
+    }
+    if(detailedTimers) stopwatch.start(calcTimers[pe.index]);
+    if(pe.av){
+      pe.av->clearInputForces();
+      pe.av->clearDerivatives();
     }
-    ActionWithValue*av=dynamic_cast<ActionWithValue*>(*p);
-    ActionAtomistic*aa=dynamic_cast<ActionAtomistic*>(*p);
-    {
-      if(av) av->clearInputForces();
-      if(av) av->clearDerivatives();
+    if(pe.aa){
+      pe.aa->clearOutputForces();
+      pe.aa->retrieveAtoms();
     }
-    {
-      if(aa) aa->clearOutputForces();
-      if(aa) if(aa->isActive()) aa->retrieveAtoms();
+    if(pe.action->checkNumericalDerivatives()) pe.action->calculateNumericalDerivatives();
+    else {
+      delaySums=pe.action;
+      pe.action->calculate();
+      delaySums=NULL;
     }
-    if((*p)->isActive()){
-      if((*p)->checkNumericalDerivatives()) (*p)->calculateNumericalDerivatives();
-      else (*p)->calculate();
-      // This retrieves components called bias 
-      if(av) bias+=av->getOutputQuantity("bias");
-      if(av) work+=av->getOutputQuantity("work");
-      if(av)av->setGradientsIfNeeded();	
-      ActionWithVirtualAtom*avv=dynamic_cast<ActionWithVirtualAtom*>(*p);
-      if(avv)avv->setGradientsIfNeeded();	
+    if(pe.action->checkSumsPending()) pendingSums.push_back(i);
+    else finishActionCalculation(pe);
+
+    if(detailedTimers) stopwatch.stop(calcTimers[pe.index]);
+  }
+  completeSums();
+  stopwatch.stop(TIMER_CALC);
+}
+
+void PlumedMain::finishActionCalculation(const PlanEntry & pe){
+  // This retrieves components called bias 
+  if(pe.ibias>=0) bias+=pe.av->getOutputQuantity(pe.ibias);
+  if(pe.iwork>=0) work+=pe.av->getOutputQuantity(pe.iwork);
+  if(pe.av)pe.av->setGradientsIfNeeded();	
+  if(pe.avv)pe.avv->setGradientsIfNeeded();	
+}
+
+void PlumedMain::completeSums(){
+  startSums();
+  waitEnsembleSums();
+}
+
+void PlumedMain::startSums(){
+  if(pendingSums.empty()) return;
+// only one average over the replicas is in flight at a time
+  waitEnsembleSums();
+  unsigned n=0;
+  for(unsigned i=0;i<pendingSums.size();++i) n+=plan[pendingSums[i]].action->getSizeOfSums();
+  pendingSumsBuffer.resize(n);
+  n=0;
+  for(unsigned i=0;i<pendingSums.size();++i){
+    Action* p=plan[pendingSums[i]].action;
+    p->packSums(&pendingSumsBuffer[n]);
+    n+=p->getSizeOfSums();
+  }
+  if(comm.Get_size()>1 && n>0) comm.Sum(pendingSumsBuffer);
+  n=0;
+  for(unsigned i=0;i<pendingSums.size();++i){
+    Action* p=plan[pendingSums[i]].action;
+    unsigned size=p->getSizeOfSums();
+    p->unpackSums(&pendingSumsBuffer[n]);
+    n+=size;
+  }
+// the actions that do not need an average over the replicas are finished now,
+// the buffers of the others are packed and reduced together
+  n=0;
+  for(unsigned i=0;i<pendingSums.size();++i){
+    const PlanEntry & pe(plan[pendingSums[i]]);
+    unsigned size=pe.action->getSizeOfEnsembleAverages();
+    if(size>0){
+      ensembleSums.push_back(pendingSums[i]);
+      n+=size;
+    } else {
+      pe.action->finishSums();
+      finishActionCalculation(pe);
     }
+  }
+  pendingSums.clear();
+  if(ensembleSums.empty()) return;
+  ensembleSumsBuffer.resize(n);
+  n=0;
+  for(unsigned i=0;i<ensembleSums.size();++i){
+    Action* p=plan[ensembleSums[i]].action;
+    p->packEnsembleAverages(&ensembleSumsBuffer[n]);
+    n+=p->getSizeOfEnsembleAverages();
+  }
+// the replicas are reduced among the first processes of each replica only
+  if(comm.Get_rank()==0) ensembleSumsRequest=multi_sim_comm.Isum(ensembleSumsBuffer);
+}
+
+void PlumedMain::waitEnsembleSums(){
+  if(ensembleSums.empty()) return;
+  ensembleSumsRequest.wait();
+  shareReplicaAverage(ensembleSumsBuffer);
+  unsigned n=0;
+  for(unsigned i=0;i<ensembleSums.size();++i){
+    const PlanEntry & pe(plan[ensembleSums[i]]);
+    unsigned size=pe.action->getSizeOfEnsembleAverages();
+    pe.action->unpackEnsembleAverages(&ensembleSumsBuffer[n]);
+    n+=size;
+    pe.action->finishSums();
+    finishActionCalculation(pe);
+  }
+  ensembleSums.clear();
+}
+
+void PlumedMain::averageOverReplicas(std::vector<double>&buffer){
+  if(comm.Get_rank()==0) multi_sim_comm.Sum(buffer);
+  shareReplicaAverage(buffer);
+}
 
-    if(detailedTimers) stopwatch.stop(actionNumberLabel);
-    iaction++;
+void PlumedMain::shareReplicaAverage(std::vector<double>&buffer){
+  if(comm.Get_rank()==0){
+    double fact=1.0/multi_sim_comm.Get_size();
+    for(unsigned i=0;i<buffer.size();++i) buffer[i]*=fact;
+  }
+  if(comm.Get_size()>1) comm.Bcast(buffer,0);
+}
+
+void PlumedMain::setupActionLevels(){
+  std::map<Action*,unsigned> position;
+  std::vector<unsigned> level( plan.size() );
+  levelDependencies.resize( plan.size() );
+// active atomistic actions that are not ActionWithValue (e.g. WHOLEMOLECULES) can change the positions 
+// used by the actions that follow them so they are given a level of their own
+  unsigned first=0, nlevels=0;
+  for(unsigned i=0;i<plan.size();++i){
+    Action* p=plan[i].action; position[p]=i;
+    levelDependencies[i]=p->getDependencies();
+    bool barrier=( plan[i].aa && !plan[i].av );
+    unsigned mylevel=first;
+    if( barrier ) mylevel=nlevels;
+    const Action::Dependencies & deps(levelDependencies[i]);
+    for(unsigned j=0;j<deps.size();++j){
+      plumed_massert( position.count(deps[j]), "action " + p->getLabel() + " depends on an action that is not calculated before it" );
+      unsigned dlevel=level[ position[deps[j]] ]+1;
+      if( dlevel>mylevel ) mylevel=dlevel;
+    }
+    level[i]=mylevel;
+    if( mylevel>=nlevels ) nlevels=mylevel+1;
+    if( barrier ) first=nlevels;
+  }
+  actionLevels.assign( nlevels, std::vector<unsigned>() );
+  for(unsigned i=0;i<plan.size();++i) actionLevels[ level[i] ].push_back( i );
+
+// actions that can change the state of their dependencies (e.g. multicolvar functions that recompute the
+// tasks of their base multicolvar in LOWMEM mode) may do so all the way down the chain of dependencies
+  std::vector< std::vector<unsigned> > modified( plan.size() );
+  std::vector<unsigned> visited( plan.size(), plan.size() );
+  for(unsigned i=0;i<plan.size();++i){
+    if( !plan[i].action->checkModifiesDependencies() ) continue;
+    std::vector<unsigned> stack( 1, i );
+    while( !stack.empty() ){
+      unsigned k=stack.back(); stack.pop_back();
+      for(unsigned j=0;j<levelDependencies[k].size();++j){
+        unsigned d=position[ levelDependencies[k][j] ];
+        if( visited[d]==i ) continue;
+        visited[d]=i; modified[i].push_back(d); stack.push_back(d);
+      }
+    }
+  }
+
+// the actions in each level are split into groups so that an action is never calculated at the same time
+// as another action that uses one of the actions it can modify.  Doing this in a fixed order makes the 
+// grouping independent of the number of threads
+  calcGroups.assign( nlevels, std::vector< std::vector<unsigned> >() );
+  for(unsigned ilev=0;ilev<nlevels;++ilev){
+    std::vector< std::vector<unsigned> > & groups(calcGroups[ilev]);
+    std::vector< std::set<unsigned> > used, changed;
+    for(unsigned i=0;i<actionLevels[ilev].size();++i){
+      unsigned k=actionLevels[ilev][i];
+      const Action::Dependencies & deps(levelDependencies[k]);
+      unsigned igroup=0;
+      for(;igroup<groups.size();++igroup){
+        bool clash=false;
+        for(unsigned j=0;j<deps.size() && !clash;++j) if( changed[igroup].count( position[deps[j]] ) ) clash=true;
+        for(unsigned j=0;j<modified[k].size() && !clash;++j) if( used[igroup].count( modified[k][j] ) ) clash=true;
+        if(!clash) break;
+      }
+      if(igroup==groups.size()){ groups.resize(igroup+1); used.resize(igroup+1); changed.resize(igroup+1); }
+      groups[igroup].push_back(k);
+      for(unsigned j=0;j<deps.size();++j) used[igroup].insert( position[deps[j]] );
+      changed[igroup].insert( modified[k].begin(), modified[k].end() );
+    }
+  }
+}
+
+void PlumedMain::justCalculateConcurrently(){
+// the levels are only redone when the active actions or their dependencies (e.g. the virtual atoms
+// requested after a neighbor list update) change
+  bool newdeps=newLevels;
+  for(unsigned i=0;i<plan.size() && !newdeps;++i) if( plan[i].action->getDependencies()!=levelDependencies[i] ) newdeps=true;
+  if(newdeps){ setupActionLevels(); newLevels=false; }
+
+// threads are only used when plumed is running on a single process, since actions in the same 
+// level would otherwise call the collective communications in a different order on each process
+  unsigned nt=OpenMP::getNumThreads();
+  if(comm.Get_size()>1 || multi_sim_comm.Get_size()>1) nt=1;
+
+  for(unsigned ilev=0;ilev<actionLevels.size();++ilev){
+    const std::vector<unsigned> & mylevel(actionLevels[ilev]);
+    for(unsigned i=0;i<mylevel.size();++i){
+      const PlanEntry & pe(plan[mylevel[i]]);
+      if(pe.av){
+        pe.av->clearInputForces();
+        pe.av->clearDerivatives();
+      }
+      if(pe.aa){
+        pe.aa->clearOutputForces();
+        pe.aa->retrieveAtoms();
+      }
+    }
+    for(unsigned igroup=0;igroup<calcGroups[ilev].size();++igroup){
+      const std::vector<unsigned> & mygroup(calcGroups[ilev][igroup]);
+      unsigned mynt=nt; if(mynt>mygroup.size()) mynt=mygroup.size();
+      if(mynt==0) mynt=1;
+      #pragma omp parallel for num_threads(mynt) schedule(dynamic,1)
+      for(unsigned i=0;i<mygroup.size();++i){
+        const PlanEntry & pe(plan[mygroup[i]]);
+        if(detailedTimers){
+          #pragma omp critical (plumed_main_stopwatch)
+          stopwatch.start(calcTimers[pe.index]);
+        }
+        if(pe.action->checkNumericalDerivatives()) pe.action->calculateNumericalDerivatives();
+        else pe.action->calculate();
+        if(pe.av)pe.av->setGradientsIfNeeded();
+        if(pe.avv)pe.avv->setGradientsIfNeeded();
+        if(detailedTimers){
+          #pragma omp critical (plumed_main_stopwatch)
+          stopwatch.stop(calcTimers[pe.index]);
+        }
+      }
+    }
+  }
+
+// the bias and work are summed in input order so the result does not depend on the schedule
+  for(unsigned i=0;i<plan.size();++i){
+    if(plan[i].ibias>=0) bias+=plan[i].av->getOutputQuantity(plan[i].ibias);
+    if(plan[i].iwork>=0) work+=plan[i].av->getOutputQuantity(plan[i].iwork);
+  }
+}
+
+void PlumedMain::justApplyConcurrently(){
+  unsigned nt=OpenMP::getNumThreads();
+  if(comm.Get_size()>1 || multi_sim_comm.Get_size()>1) nt=1;
+
+  for(unsigned ilev=actionLevels.size();ilev>0;--ilev){
+    const std::vector<unsigned> & mylevel(actionLevels[ilev-1]);
+// actions that add forces to the same action cannot be applied at the same time.  The actions in the level 
+// are thus split into groups that add forces on different actions.  Doing this in a fixed order makes
+// the accumulated forces independent of the number of threads
+    std::vector< std::vector<unsigned> > groups; std::vector< std::set<Action*> > forced;
+    for(unsigned i=mylevel.size();i>0;--i){
+      Action* p=plan[mylevel[i-1]].action;
+      if(!p->checkNeedsApply()) continue;
+      const Action::Dependencies & deps(p->getDependencies());
+      unsigned igroup=0;
+      for(;igroup<groups.size();++igroup){
+        bool clash=false;
+        for(unsigned j=0;j<deps.size();++j) if( forced[igroup].count(deps[j]) ){ clash=true; break; }
+        if(!clash) break;
+      }
+      if(igroup==groups.size()){ groups.resize(igroup+1); forced.resize(igroup+1); }
+      groups[igroup].push_back(mylevel[i-1]); forced[igroup].insert( deps.begin(), deps.end() );
+    }
+
+    for(unsigned igroup=0;igroup<groups.size();++igroup){
+      const std::vector<unsigned> & mygroup(groups[igroup]);
+      unsigned mynt=nt; if(mynt>mygroup.size()) mynt=mygroup.size();
+      if(mynt==0) mynt=1;
+      #pragma omp parallel for num_threads(mynt) schedule(dynamic,1)
+      for(unsigned i=0;i<mygroup.size();++i){
+        const PlanEntry & pe(plan[mygroup[i]]);
+        if(detailedTimers){
+          #pragma omp critical (plumed_main_stopwatch)
+          stopwatch.start(applyTimers[pe.index]);
+        }
+        pe.action->apply();
+        if(detailedTimers){
+          #pragma omp critical (plumed_main_stopwatch)
+          stopwatch.stop(applyTimers[pe.index]);
+        }
+      }
+// forces on atoms are all added to the same array so this is done in serial
+      for(unsigned i=0;i<mygroup.size();++i){
+        const PlanEntry & pe(plan[mygroup[i]]);
+        if(pe.aa) pe.aa->applyForces();
+      }
+    }
+  }
+}
+
+void PlumedMain::reportCriticalPath(){
+// this uses the time spent in each action during the forward loop
+  std::map<Action*,unsigned> position;
+  for(unsigned i=0;i<actionSet.size();++i) position[actionSet[i]]=i;
+  std::vector<double> pathtime( actionSet.size(), 0.0 );
+  std::vector<int> previous( actionSet.size(), -1 );
+  int last=-1;
+  for(unsigned i=0;i<actionSet.size();++i){
+    const Action::Dependencies & deps(actionSet[i]->getDependencies());
+    for(unsigned j=0;j<deps.size();++j){
+      unsigned k=position[deps[j]];
+      if( previous[i]<0 || pathtime[k]>pathtime[previous[i]] ) previous[i]=k;
+    }
+    if(i<calcTimers.size()) pathtime[i]=stopwatch.getTotal(calcTimers[i]);
+    if( previous[i]>=0 ) pathtime[i]+=pathtime[previous[i]];
+    if( last<0 || pathtime[i]>pathtime[last] ) last=i;
+  }
+  if(last<0) return;
+
+  std::vector<unsigned> path;
+  for(int i=last;i>=0;i=previous[i]) path.push_back(i);
+  log.printf("Critical path through the forward loop (%u actions, %f seconds in total):\n",unsigned(path.size()),pathtime[last]);
+  for(unsigned i=path.size();i>0;--i){
+    unsigned k=path[i-1];
+    double mytime=pathtime[k]; if( previous[k]>=0 ) mytime-=pathtime[previous[k]];
+    log.printf("  %-40s %12.6f\n",actionSet[k]->getLabel().c_str(),mytime);
+  }
+}
+
+void PlumedMain::reportEvaluations(){
+  log.printf("Number of steps on which each action was calculated (out of %u steps with active actions):\n",nActiveSteps);
+  log.printf("  %-40s %12s %12s\n","action","calculated","skipped");
+  for(unsigned i=0;i<calcCount.size();++i){
+    log.printf("  %-40s %12u %12u\n",actionSet[i]->getLabel().c_str(),calcCount[i],nActiveSteps-calcCount[i]);
+  }
+}
+
+void PlumedMain::setupActionTimers(){
+// the stopwatches are registered once so that no string is built during the step
+  calcTimers.resize(actionSet.size());
+  applyTimers.resize(actionSet.size());
+  for(unsigned i=0;i<actionSet.size();++i){
+    std::string num; Tools::convert(i,num);
+    calcTimers[i]=stopwatch.getWatchIndex("4A "+num+" "+actionSet[i]->getLabel());
+    Tools::convert(unsigned(actionSet.size()-1-i),num);
+    applyTimers[i]=stopwatch.getWatchIndex("5A "+num+" "+actionSet[i]->getLabel());
   }
-  stopwatch.stop("4 Calculating (forward loop)");
 }
 
 void PlumedMain::justApply(){
   
   if(!active)return;
-  int iaction=0;
-  stopwatch.start("5 Applying (backward loop)");
+  stopwatch.start(TIMER_APPLY);
 // apply them in reverse order
-  for(ActionSet::reverse_iterator p=actionSet.rbegin();p!=actionSet.rend();++p){
-    if((*p)->isActive()){
-
-      std::string actionNumberLabel;
-      if(detailedTimers){
-        Tools::convert(iaction,actionNumberLabel);
-        actionNumberLabel="5A "+actionNumberLabel+" "+(*p)->getLabel();
-        stopwatch.start(actionNumberLabel);
-      }
+  if(concurrentActions) justApplyConcurrently();
+  else for(unsigned i=plan.size();i>0;--i){
+    const PlanEntry & pe(plan[i-1]);
+// actions that have no forces on them are skipped, so nothing is done for actions that are only monitored
+    if(!pe.action->checkNeedsApply()) continue;
+
+    if(detailedTimers) stopwatch.start(applyTimers[pe.index]);
 
-      (*p)->apply();
-      ActionAtomistic*a=dynamic_cast<ActionAtomistic*>(*p);
+    pe.action->apply();
 // still ActionAtomistic has a special treatment, since they may need to add forces on atoms
-      if(a) a->applyForces();
+    if(pe.aa) pe.aa->applyForces();
 
-      if(detailedTimers) stopwatch.stop(actionNumberLabel);
-    }
-    iaction++;
+    if(detailedTimers) stopwatch.stop(applyTimers[pe.index]);
   }
 
 // this is updating the MD copy of the forces
-  if(detailedTimers) stopwatch.start("5B Update forces");
+  if(detailedTimers) stopwatch.start(TIMER_UPDATEFORCES);
   if(atoms.getNatoms()>0) atoms.updateForces();
-  if(detailedTimers) stopwatch.stop("5B Update forces");
+  if(detailedTimers) stopwatch.stop(TIMER_UPDATEFORCES);
 
-  if(detailedTimers) stopwatch.start("5C Update");
+  if(detailedTimers) stopwatch.start(TIMER_UPDATE);
 // update step (for statistics, etc)
-  for(ActionSet::iterator p=actionSet.begin();p!=actionSet.end();++p){
-    if((*p)->isActive() && (*p)->checkUpdate()) (*p)->update();
+  for(unsigned i=0;i<plan.size();++i){
+    if(plan[i].action->checkUpdate()) plan[i].action->update();
   }
-  if(detailedTimers) stopwatch.stop("5C Update");
+  if(detailedTimers) stopwatch.stop(TIMER_UPDATE);
 // Check that no action has told the calculation to stop
   if(stopNow){
      if(stopFlag) (*stopFlag)=1;
      else plumed_merror("your md code cannot handle plumed stop events - add a call to plumed.comm(stopFlag,stopCondition)");
   }  
-  stopwatch.stop("5 Applying (backward loop)");
+  stopwatch.stop(TIMER_APPLY);
 
 // flush by default every 10000 steps
 // hopefully will not affect performance
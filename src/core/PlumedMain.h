@@ -23,6 +23,7 @@
 #define __PLUMED_core_PlumedMain_h
 
 #include "WithCmd.h"
+#include "tools/Communicator.h"
 #include <cstdio>
 #include <string>
 #include <vector>
@@ -50,13 +51,15 @@ namespace PLMD {
 
 
 
+class Action;
 class ActionAtomistic;
 class ActionPilot;
+class ActionWithValue;
+class ActionWithVirtualAtom;
 class Log;
 class Atoms;
 class ActionSet;
 class DLLoader;
-class Communicator;
 class Stopwatch;
 class Citations;
 class ExchangePatterns;
@@ -140,6 +143,81 @@ private:
   int* stopFlag;
   bool stopNow;
 
+/// Everything the forward and backward loops need to know about one of the active actions
+  class PlanEntry{
+  public:
+/// The position of the action in the set of actions
+    unsigned index;
+    Action* action;
+    ActionWithValue* av;
+    ActionAtomistic* aa;
+    ActionWithVirtualAtom* avv;
+/// The indices of the bias and work components (negative if there are none)
+    int ibias, iwork;
+  };
+/// The active actions in the order they are calculated. This is only redone when the active actions change
+  std::vector<PlanEntry> plan;
+/// The activity of each action when the plan was made
+  std::vector<bool> planActivity;
+/// Make the plan for the forward and backward loops
+  void setupPlan();
+
+/// The positions in the plan of the actions sorted into levels. Actions only depend on actions
+/// in lower levels so the actions within each level can be performed at the same time
+  std::vector< std::vector<unsigned> > actionLevels;
+/// The actions of each level split into the groups that are calculated at the same time.
+/// Actions that can change their dependencies are not grouped with actions that use them
+  std::vector< std::vector< std::vector<unsigned> > > calcGroups;
+/// The dependencies of the actions in the plan when the levels were made
+  std::vector< std::vector<Action*> > levelDependencies;
+/// True if the plan has changed since the levels were made
+  bool newLevels;
+/// Sort the actions into levels using the dependencies between them
+  void setupActionLevels();
+/// Perform the forward loop one level at a time
+  void justCalculateConcurrently();
+/// Perform the backward loop one level at a time
+  void justApplyConcurrently();
+/// Write the chain of dependent actions that took the most time to the log
+  void reportCriticalPath();
+
+/// The indices of the stopwatches used for each action in the forward and backward loops
+  std::vector<unsigned> calcTimers, applyTimers;
+/// Register the stopwatches for each action
+  void setupActionTimers();
+
+/// The number of steps on which each action has been calculated
+  std::vector<unsigned> calcCount;
+/// The number of steps on which at least one action has been calculated
+  unsigned nActiveSteps;
+/// Write to the log how many times each action has been calculated
+  void reportEvaluations();
+
+/// The action that is being calculated in the serial forward loop, whose sums can be delayed.
+/// Other actions that are calculated from it (e.g. through a bridge) do their sums at once
+  const Action* delaySums;
+/// The positions in the plan of the actions whose sums have been delayed
+  std::vector<unsigned> pendingSums;
+/// The packed buffers of the actions whose sums have been delayed
+  std::vector<double> pendingSumsBuffer;
+/// The positions in the plan of the actions whose buffers are being averaged over the replicas
+  std::vector<unsigned> ensembleSums;
+/// The packed buffers of the actions whose buffers are being averaged over the replicas
+  std::vector<double> ensembleSumsBuffer;
+/// The request of the nonblocking sum of ensembleSumsBuffer over the replicas
+  Communicator::Request ensembleSumsRequest;
+/// Sum the buffers of all the actions whose sums have been delayed with a single call to comm.Sum
+/// and start a single nonblocking average over the replicas of the buffers that need it
+  void startSums();
+/// Wait for the average over the replicas started in startSums() and finish the actions involved
+  void waitEnsembleSums();
+/// Do all the sums that have been delayed
+  void completeSums();
+/// Divide the sum over the replicas by their number and share it with all the processes in comm
+  void shareReplicaAverage(std::vector<double>&);
+/// Things that are done for each action in the forward loop once it has been fully calculated
+  void finishActionCalculation(const PlanEntry&);
+
 public:
 /// Flag to switch off virial calculation (for debug and MD codes with no barostat)
   bool novirial;
@@ -147,11 +225,16 @@ public:
 /// Flag to switch on detailed timers
   bool detailedTimers;
 
+/// Flag to perform actions that do not depend on each other at the same time
+  bool concurrentActions;
+
 /// Add a citation, returning a string containing the reference number, something like "[10]"
   std::string cite(const std::string&);
 
 /// word list command
   std::map<std::string, int> word_map;
+/// names of the commands, indexed by their handle
+  std::vector<std::string> word_names;
 
 /// Get number of threads that can be used by openmp
   unsigned getNumThreads()const;
@@ -179,6 +262,14 @@ public:
  Notice that this interface should always keep retro-compatibility
 */
   void cmd(const std::string&key,void*val=NULL);
+/**
+ Execute a single word command identified by its handle.
+ \param handle The handle of the command, as returned by cmd("getCommandHandle name").
+ \param val The argument of the command to be executed.
+ It is called as plumed_hcmd() or as PLMD::Plumed::hcmd() and avoids
+ looking up the command name at every step
+*/
+  void cmd(int handle,void*val=NULL);
   ~PlumedMain();
 /**
   Read an input file.
@@ -250,6 +341,12 @@ public:
   const ActionSet & getActionSet()const;
 /// Referenge to the log stream
   Log & getLog();
+/// Reference to the timers
+  const Stopwatch & getStopwatch()const{return stopwatch;}
+/// Check if an action can leave its sums for later (see Action::doSums)
+  bool canDelaySums(const Action*a)const{return a==delaySums;}
+/// Average a buffer over the replicas. The value of this replica is taken from the first process in comm
+  void averageOverReplicas(std::vector<double>&);
 /// Return the number of the step
   long int getStep()const{return step;}
 /// Stop the run
@@ -52,6 +52,11 @@ extern "C" void plumedmain_cmd(void*plumed,const char*key,const void*val){
   static_cast<PLMD::PlumedMain*>(plumed)->cmd(key,val);
 }
 
+extern "C" void plumedmain_cmd_handle(void*plumed,int handle,const void*val){
+  plumed_massert(plumed,"trying to use a plumed object which is not initialized");
+  static_cast<PLMD::PlumedMain*>(plumed)->cmd(handle,const_cast<void*>(val));
+}
+
 extern "C" void plumedmain_finalize(void*plumed){
   plumed_massert(plumed,"trying to deallocate a plumed object which is not initialized");
   delete static_cast<PLMD::PlumedMain*>(plumed);
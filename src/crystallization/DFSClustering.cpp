@@ -43,18 +43,20 @@ private:
   int number_of_cluster;
 /// The values from the underlying colvar
   std::vector<double> myvals;
-/// The number of neighbors each atom has
-  std::vector<unsigned> nneigh;
-/// The adjacency list
-  Matrix<unsigned> adj_list;
+/// The start of the list of neighbors of each atom in adj_list
+  std::vector<unsigned> adj_start;
+/// The adjacency lists of all the atoms
+  std::vector<unsigned> adj_list;
 /// Vector that stores the sizes of the current set of clusters
   std::vector< std::pair<unsigned,unsigned> > cluster_sizes;
 /// Vector that identifies the cluster each atom belongs to
   std::vector<unsigned> which_cluster;
-/// The color that tells us whether a node has been visited
-  std::vector<unsigned> color;
-/// The recursive function at the heart of this method
-  int explore( const unsigned& index );
+/// The parent of each atom and the size of each tree in the union-find forest
+  std::vector<unsigned> parent, treesize;
+/// The cluster number assigned to the root of each tree 
+  std::vector<int> root_cluster;
+/// Find the root of the tree that contains an atom
+  unsigned findRoot( unsigned index );
 public:
 /// Create manual
   static void registerKeywords( Keywords& keys );
@@ -87,11 +89,12 @@ void DFSClustering::registerKeywords( Keywords& keys ){
 DFSClustering::DFSClustering(const ActionOptions&ao):
 Action(ao),
 AdjacencyMatrixAction(ao),
-nneigh(getFullNumberOfBaseTasks()),
-adj_list(getFullNumberOfBaseTasks(),getFullNumberOfBaseTasks()),
+adj_start(getFullNumberOfBaseTasks()+1),
 cluster_sizes(getFullNumberOfBaseTasks()),
 which_cluster(getFullNumberOfBaseTasks()),
-color(getFullNumberOfBaseTasks())
+parent(getFullNumberOfBaseTasks()),
+treesize(getFullNumberOfBaseTasks()),
+root_cluster(getFullNumberOfBaseTasks())
 {
    if( getNumberOfBaseMultiColvars()!=1 ) error("should only be running DFS Clustering with one base multicolvar");
    // Find out which cluster we want
@@ -125,20 +128,29 @@ unsigned DFSClustering::getNumberOfQuantities(){
 
 void DFSClustering::completeCalculation(){
    // Get the adjacency matrix
-   retrieveAdjacencyLists( nneigh, adj_list ); 
-//   for(unsigned i=0;i<nneigh.size();++i){
-//       printf("ADJACENCY LIST FOR %d HAS %d MEMBERS : ",i,nneigh[i]);
-//       for(unsigned j=0;j<nneigh[i];++j) printf("%d ",adj_list(i,j) );
-//       printf("\n"); 
-//   }
+   retrieveAdjacencyLists( adj_start, adj_list ); 
 
    // All the clusters have zero size initially
    for(unsigned i=0;i<cluster_sizes.size();++i){ cluster_sizes[i].first=0; cluster_sizes[i].second=i;}
 
-   // Perform clustering
-   number_of_cluster=-1; color.assign(color.size(),0);
+   // Perform clustering by merging the trees containing each pair of adjacent atoms
+   for(unsigned i=0;i<parent.size();++i){ parent[i]=i; treesize[i]=1; }
    for(unsigned i=0;i<getFullNumberOfBaseTasks();++i){
-      if( color[i]==0 ){ number_of_cluster++; color[i]=explore(i); } 
+      for(unsigned k=adj_start[i];k<adj_start[i+1];++k){
+         if( adj_list[k]<i ) continue;
+         unsigned iroot=findRoot(i), jroot=findRoot( adj_list[k] );
+         if( iroot==jroot ) continue;
+         if( treesize[iroot]<treesize[jroot] ) std::swap( iroot, jroot );
+         parent[jroot]=iroot; treesize[iroot]+=treesize[jroot];
+      }
+   }
+
+   // Number the clusters in the order of the lowest index atom they contain
+   number_of_cluster=-1; root_cluster.assign( root_cluster.size(), -1 );
+   for(unsigned i=0;i<getFullNumberOfBaseTasks();++i){
+      unsigned iroot=findRoot(i);
+      if( root_cluster[iroot]<0 ){ number_of_cluster++; root_cluster[iroot]=number_of_cluster; }
+      which_cluster[i]=root_cluster[iroot]; cluster_sizes[ which_cluster[i] ].first++;
    }
 
    // Order the clusters in the system by size (this returns ascending order )
@@ -177,18 +189,12 @@ void DFSClustering::completeCalculation(){
    finishComputations();
 }
 
-int DFSClustering::explore( const unsigned& index ){
-
-   color[index]=1;
-   for(unsigned i=0;i<nneigh[index];++i){
-       unsigned j=adj_list(index,i);
-       if( color[j]==0 ) color[j]=explore(j);
+unsigned DFSClustering::findRoot( unsigned index ){
+   // Path halving keeps the trees shallow without the need for recursion
+   while( parent[index]!=index ){
+      parent[index]=parent[ parent[index] ]; index=parent[index];
    }
-
-   // Count the size of the cluster
-   cluster_sizes[number_of_cluster].first++;
-   which_cluster[index] = number_of_cluster;
-   return color[index];
+   return index;
 }
 
 }
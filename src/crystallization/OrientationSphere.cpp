@@ -51,6 +51,7 @@ MultiColvarFunction(ao)
   catom_orient.resize( ncomponents ); 
   catom_der.resize( ncomponents );
   this_orient.resize( ncomponents ); 
+  catom_totder.resize( ncomponents );
 
   // Weight of this does not have derivatives
   weightHasDerivatives=false;
@@ -72,6 +73,18 @@ MultiColvarFunction(ao)
 
   // Finish the setup of the object
   buildSymmetryFunctionLists();
+
+  // Keep pointers to the vectors and resize the arrays that hold the neighbors
+  vecbase.resize( getNumberOfBaseMultiColvars() );
+  for(unsigned i=0;i<vecbase.size();++i){
+      vecbase[i]=dynamic_cast<VectorMultiColvar*>( getBaseMultiColvar(i) );
+      if( !vecbase[i] ) error("input multicolvar is not calculating a vector");
+      if( vecbase[i]->getNumberOfQuantities()-5!=ncomponents ) error("mismatch between the number of components in the input vectors");
+  }
+  unsigned maxneigh=current_atoms.size();
+  neigh_atoms.resize( maxneigh ); neigh_tasks.resize( maxneigh ); neigh_sw.resize( maxneigh ); 
+  neigh_dfunc.resize( maxneigh ); neigh_dot.resize( maxneigh ); neigh_dist.resize( maxneigh );
+  block_tasks.resize( maxneigh ); block_pos.resize( maxneigh ); block_dots.resize( maxneigh );
 }
 
 void OrientationSphere::calculateWeight(){
@@ -81,42 +94,65 @@ void OrientationSphere::calculateWeight(){
 
 double OrientationSphere::compute(){
    // Make sure derivatives for central atom are only calculated once
-   VectorMultiColvar* vv = dynamic_cast<VectorMultiColvar*>( getBaseMultiColvar(0) );
+   VectorMultiColvar* vv = vecbase[ getBaseColvarNumber(0) ];
    vv->firstcall=true;
 
    weightHasDerivatives=true;   // The weight has no derivatives really
-   double d2, sw, value=0, denom=0, dot, f_dot, dot_df, dfunc; Vector distance;
+   double d2, value=0, denom=0, f_dot, dot_df; 
 
-   getVectorForBaseTask(0, catom_orient );
+   // Find the neighbors that are within the cutoff
+   unsigned nneigh=0;
    for(unsigned i=1;i<getNAtoms();++i){
-      distance=getSeparation( getPositionOfCentralAtom(0), getPositionOfCentralAtom(i) );
+      Vector distance=getSeparation( getPositionOfCentralAtom(0), getPositionOfCentralAtom(i) );
       d2 = distance.modulo2();
       if( d2<rcut2 ){ 
-         sw = switchingFunction.calculateSqr( d2, dfunc );  
- 
-         getVectorForBaseTask( i, this_orient );
-         // Calculate the dot product wrt to this position 
-         dot=0; for(unsigned k=0;k<catom_orient.size();++k) dot+=catom_orient[k]*this_orient[k];  
-         f_dot = transformDotProduct( dot, dot_df ); 
+         neigh_atoms[nneigh]=i; neigh_dist[nneigh]=distance;
+         neigh_sw[nneigh] = switchingFunction.calculateSqr( d2, neigh_dfunc[nneigh] );  
+         neigh_tasks[nneigh]=convertToLocalIndex( current_atoms[i], getBaseColvarNumber(i) );
+         nneigh++;
+      }
+   }
+
+   // Calculate the dot products with all the neighbors from each base multicolvar in one block
+   vv->vecs->getStoredVector( convertToLocalIndex( current_atoms[0], getBaseColvarNumber(0) ), catom_orient );
+   for(unsigned ibase=0;ibase<vecbase.size();++ibase){
+      unsigned nblock=0;
+      for(unsigned j=0;j<nneigh;++j){
+         if( getBaseColvarNumber( neigh_atoms[j] )!=ibase ) continue;
+         block_tasks[nblock]=neigh_tasks[j]; block_pos[nblock]=j; nblock++;
+      }
+      if( nblock==0 ) continue;
+      vecbase[ibase]->vecs->calculateDotProducts( catom_orient, nblock, block_tasks, block_dots );
+      for(unsigned j=0;j<nblock;++j) neigh_dot[ block_pos[j] ]=block_dots[j];
+   }
+
+   catom_totder.assign( catom_totder.size(), 0.0 );
+   for(unsigned j=0;j<nneigh;++j){
+      unsigned i=neigh_atoms[j]; double sw=neigh_sw[j], dfunc=neigh_dfunc[j]; 
+      const Vector & distance=neigh_dist[j];
+
+      f_dot = transformDotProduct( neigh_dot[j], dot_df ); 
+      if( !doNotCalculateDerivatives() ){
+         vecbase[ getBaseColvarNumber(i) ]->vecs->getStoredVector( neigh_tasks[j], this_orient );
          // N.B. We are assuming here that the imaginary part of the dot product is zero
          for(unsigned k=0;k<catom_orient.size();++k){
-            this_orient[k]*=sw*dot_df; catom_der[k]=sw*dot_df*catom_orient[k];
+            catom_totder[k]+=sw*dot_df*this_orient[k]; catom_der[k]=sw*dot_df*catom_orient[k];
          }  
-
-         // Set the derivatives wrt of the numerator
-         addOrientationDerivatives( 0, this_orient ); 
+         // Set the derivatives wrt of the numerator (those of the central atom are added once at the end)
          addOrientationDerivatives( i, catom_der );  
-         addCentralAtomsDerivatives( 0, 0, f_dot*(-dfunc)*distance );
-         addCentralAtomsDerivatives( i, 0, f_dot*(dfunc)*distance );
-         addBoxDerivatives( f_dot*(-dfunc)*Tensor(distance,distance) );
-         value += sw*f_dot;
-         // Set the derivatives wrt to the numerator
-         addCentralAtomsDerivatives( 0, 1, (-dfunc)*distance );
-         addCentralAtomsDerivatives( i, 1, (dfunc)*distance );
-         addBoxDerivativesOfWeight( (-dfunc)*Tensor(distance,distance) );
-         denom += sw;
       }
+      addCentralAtomsDerivatives( 0, 0, f_dot*(-dfunc)*distance );
+      addCentralAtomsDerivatives( i, 0, f_dot*(dfunc)*distance );
+      addBoxDerivatives( f_dot*(-dfunc)*Tensor(distance,distance) );
+      value += sw*f_dot;
+      // Set the derivatives wrt to the numerator
+      addCentralAtomsDerivatives( 0, 1, (-dfunc)*distance );
+      addCentralAtomsDerivatives( i, 1, (dfunc)*distance );
+      addBoxDerivativesOfWeight( (-dfunc)*Tensor(distance,distance) );
+      denom += sw;
    }
+   // The chain rule is linear so the derivatives of the central vector are only needed once 
+   if( nneigh>0 ) addOrientationDerivatives( 0, catom_totder );
    
    // Now divide everything
    unsigned nder = getNumberOfDerivatives();
@@ -31,12 +31,20 @@
 namespace PLMD {
 namespace crystallization {
 
+class VectorMultiColvar;
+
 class OrientationSphere : public multicolvar::MultiColvarFunction {
 private:
   double rcut2;
-  std::vector<double> catom_orient, catom_der, this_orient;
+  std::vector<double> catom_orient, catom_der, this_orient, catom_totder;
   std::vector<double> catom_iorient, catom_ider, this_iorient;
   SwitchingFunction switchingFunction;
+/// The base multicolvars from which the vectors are taken
+  std::vector<VectorMultiColvar*> vecbase;
+/// Tempory arrays that hold information on the neighbors within the cutoff
+  std::vector<unsigned> neigh_atoms, neigh_tasks, block_tasks, block_pos;
+  std::vector<double> neigh_sw, neigh_dfunc, neigh_dot, block_dots;
+  std::vector<Vector> neigh_dist;
 public:
   static void registerKeywords( Keywords& keys );
   OrientationSphere(const ActionOptions&);
@@ -48,7 +48,34 @@ void StoreVectorsVessel::usedInFunction( const bool& store ){
   store_director=store; resize();
 }
 
-void StoreVectorsVessel::recompute( const unsigned& ivec, const unsigned& jstore ){
+void StoreVectorsVessel::resize(){
+  StoreDataVessel::resize();
+  directors.resize( ncomponents*getAction()->getFullNumberOfTasks() );
+}
+
+void StoreVectorsVessel::finish(){
+  StoreDataVessel::finish();
+  // The buffer has now been gathered so the normalized vectors are copied 
+  // once here rather than every time they are used in a function
+  unsigned ntasks=getAction()->getFullNumberOfTasks();
+  for(unsigned icomp=0;icomp<ncomponents;++icomp){
+     double* comp=&directors[icomp*ntasks];
+     for(unsigned i=0;i<ntasks;++i) comp[i]=getComponent( i, icomp );
+  }
+}
+
+void StoreVectorsVessel::calculateDotProducts( const std::vector<double>& vec, const unsigned& ntasks, 
+                                               const std::vector<unsigned>& tasks, std::vector<double>& dots ) const {
+  plumed_dbg_assert( vec.size()==ncomponents && tasks.size()>=ntasks && dots.size()>=ntasks );
+  unsigned nstored=directors.size() / ncomponents;
+  for(unsigned i=0;i<ntasks;++i) dots[i]=0.0;
+  for(unsigned icomp=0;icomp<ncomponents;++icomp){
+     const double vcomp=vec[icomp]; const double* comp=&directors[icomp*nstored];
+     for(unsigned i=0;i<ntasks;++i) dots[i] += vcomp*comp[ tasks[i] ];
+  }
+}
+
+void StoreVectorsVessel::reperformTask( const unsigned& ivec, const unsigned& jstore ){
   plumed_dbg_assert( vecs->derivativesAreRequired() && usingLowMem() ); 
   // Set the task we want to reperform
   setTaskToRecompute( ivec );
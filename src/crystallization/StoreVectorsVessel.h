@@ -38,6 +38,8 @@ private:
   bool store_director; 
   unsigned ncomponents;
   std::vector<double> myfvec;
+/// The stored vectors arranged so that the values of each component for all the tasks are contiguous
+  std::vector<double> directors;
   VectorMultiColvar* vecs;
   void normalizeVector( const int& );
 public:
@@ -46,14 +48,22 @@ public:
   StoreVectorsVessel( const vesselbase::VesselOptions& );
 /// This turns on the full use of this action for storage
   void usedInFunction( const bool& );
+/// Resize the data stores
+  void resize();
+/// Gather the data and copy the vectors to the contiguous store
+  void finish();
 /// This makes sure vectors are normalized (they are already stored)
   bool calculate();
 /// This reperforms a calculation
-  void recompute( const unsigned& , const unsigned& );
+  void reperformTask( const unsigned& , const unsigned& );
 /// This does nothing
   std::string description(){ return ""; }
 /// Get the orientation of the ith vector
   void getVector( const unsigned& , std::vector<double>& );
+/// Get the orientation of the ith vector from the contiguous store (only valid once the data has been gathered)
+  void getStoredVector( const unsigned& , std::vector<double>& ) const ;
+/// Calculate the dot products between a vector and the stored vectors for a block of tasks
+  void calculateDotProducts( const std::vector<double>& vec, const unsigned& ntasks, const std::vector<unsigned>& tasks, std::vector<double>& dots ) const ;
 /// Chain rule for component
   void chainRuleForComponent( const unsigned& , const unsigned& , const unsigned& jout, const unsigned& , const double& , multicolvar::MultiColvarFunction* );
 /// Chain rule for whole vector
@@ -66,6 +76,13 @@ void StoreVectorsVessel::getVector( const unsigned& imol, std::vector<double>& v
   for(unsigned i=0;i<getNumberOfComponents();++i) vec[i]=getComponent( imol, i );
 }
 
+inline
+void StoreVectorsVessel::getStoredVector( const unsigned& imol, std::vector<double>& vec ) const {
+  plumed_dbg_assert( vec.size()==ncomponents );
+  unsigned ntasks=directors.size() / ncomponents;
+  for(unsigned i=0;i<ncomponents;++i) vec[i]=directors[i*ntasks + imol];
+}
+
 
 
 }
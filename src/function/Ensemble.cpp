@@ -57,9 +57,11 @@ class Ensemble :
 {
   unsigned  ens_dim;
   double    fact;
+  vector<double> cvs;
 public:
   Ensemble(const ActionOptions&);
   void calculate();
+  void finishCalculation();
   static void registerKeywords(Keywords& keys);
 };
 
@@ -82,6 +84,7 @@ Function(ao)
   } else ens_dim=0; 
   comm.Sum(&ens_dim, 1);
   fact = 1./((double) ens_dim);
+  cvs.resize(getNumberOfArguments());
   for(unsigned i=0;i<getNumberOfArguments();i++) {
      std::string s=getPntrToArgument(i)->getName();
      addComponentWithDerivatives(s); 
@@ -92,20 +95,18 @@ Function(ao)
 }
 
 void Ensemble::calculate(){
+  for(unsigned i=0;i<getNumberOfArguments();++i) cvs[i]=getArgument(i);
+  // all the arguments are averaged over the replicas in a single reduction
+  addToEnsembleAverage(cvs);
+  doSums();
+}
+
+void Ensemble::finishCalculation(){
   for(unsigned i=0;i<getNumberOfArguments();++i){
-    double cv=0.;
-    if(comm.Get_rank()==0) { // I am the master of my replica
-      // among replicas
-      cv = getArgument(i);
-      multi_sim_comm.Sum(&cv, 1);
-      cv *= fact; 
-    }
-    // inside each replica
-    comm.Sum(&cv, 1);
     Value* v=getPntrToComponent(i);
-    v->set(cv);
-    setDerivative(v,cv,fact);
-  };
+    v->set(cvs[i]);
+    setDerivative(v,i,fact);
+  }
 }
 
 }
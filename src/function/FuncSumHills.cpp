@@ -173,6 +173,14 @@ double  mylogder( double v1 ){
       return 1./v1;
 }
 
+// with several projections the names of the variables are added to the name of the output file 
+string projectionFileName( const string & name, const vector<string> & proj ){
+      string suffix;
+      for(unsigned i=0;i<proj.size();i++) suffix+="_"+proj[i];
+      if(name.length()>4 && name.substr(name.length()-4)==".dat") return name.substr(0,name.length()-4)+suffix+".dat";
+      return name+suffix;
+}
+
 
 
 class FuncSumHills :
@@ -180,6 +188,7 @@ class FuncSumHills :
 {
   vector<string> hillsFiles,histoFiles; 
   vector<string> proj; 
+  vector< vector<string> > projs; 
   int initstride;
   bool iscltool,integratehills,integratehisto,parallelread;
   bool negativebias;
@@ -208,7 +217,8 @@ void FuncSumHills::registerKeywords(Keywords& keys){
   keys.add("optional","HILLSFILES"," source file for hills creation(may be the same as HILLS)"); // this can be a vector! 
   keys.add("optional","HISTOFILES"," source file for histogram creation(may be the same as HILLS)"); // also this can be a vector!
   keys.add("optional","HISTOSIGMA"," sigmas for binning when the histogram correction is needed    "); 
-  keys.add("optional","PROJ"," only with sumhills: the projection on the cvs");
+  keys.add("numbered","PROJ"," only with sumhills: the projection on the cvs. When hills are summed, several projections "
+                            "are computed in a single pass on the grid and each of them is written on a file whose name ends with its cvs");
   keys.add("optional","KT"," only with sumhills: the kt factor when projection on cvs");
   keys.add("optional","GRID_MIN","the lower bounds for the grid");
   keys.add("optional","GRID_MAX","the upper bounds for the grid");
@@ -322,8 +332,19 @@ historep(NULL)
   // needs a projection? 
   proj.clear();
   parseVector("PROJ",proj);
+  projs.clear();
+  if(proj.size()>0) projs.push_back(proj);
+  for(int i=1;;i++){
+    vector<string> p;
+    if(!parseNumberedVector("PROJ",i,p)) break;
+    projs.push_back(p);
+  }
+  if(projs.size()>0) proj=projs[0];
+  if(projs.size()>1) {
+    plumed_massert(integratehills && !integratehisto," Several projections can only be computed when summing hills ");
+  }
   if(integratehills) {
-    plumed_massert(proj.size()<getNumberOfArguments()," The number of projection must be less than the full list of arguments ");
+    for(unsigned i=0;i<projs.size();i++) plumed_massert(projs[i].size()<getNumberOfArguments()," The number of projection must be less than the full list of arguments ");
   }
   if(integratehisto) {
     plumed_massert(proj.size()<=getNumberOfArguments()," The number of projection must be less or equal to the full list of arguments ");
@@ -400,7 +421,11 @@ historep(NULL)
 
   if( proj.size() != 0 || integratehisto==true  ) {
     parse("KT",beta);
-    for(unsigned i=0;i<proj.size();i++) log<<"  projection "<<i<<" : "<<proj[i]<<"\n";
+    for(unsigned k=0;k<projs.size();k++){
+      if(projs.size()>1) log<<"  projection set "<<k+1<<"\n";
+      for(unsigned i=0;i<projs[k].size();i++) log<<"  projection "<<i<<" : "<<projs[k][i]<<"\n";
+    }
+    if(projs.size()==0) for(unsigned i=0;i<proj.size();i++) log<<"  projection "<<i<<" : "<<proj[i]<<"\n";
     // this should be only for projection or free energy from histograms
     plumed_massert(beta>0.,"if you make a projection or a histogram correction then you need KT flag!"); 
     beta=1./beta; 
@@ -518,17 +543,21 @@ historep(NULL)
     	      		log<<"  Bias: Projecting on subgrid... \n";
               		BiasWeight *Bw=new BiasWeight(beta); 
              		Grid biasGrid=*(biasrep->getGridPtr());
-   	      		Grid smallGrid=biasGrid.project(proj,Bw);
-              		OFile gridfile; gridfile.link(*this);
-	      		std::ostringstream ostr;ostr<<nfiles;
-              		string myout; 
-                        if(initstride>0){ myout=outhills+ostr.str()+".dat" ;}else{myout=outhills;}
-              		log<<"  Bias: Writing subgrid on file "<<myout<<" \n";
-              		gridfile.open(myout);	
-                        if(minTOzero) smallGrid.setMinToZero();	
-        		smallGrid.setOutputFmt(fmt); 
-   	      		smallGrid.writeToFile(gridfile);
-              		gridfile.close();
+                        // all the projections are done in a single pass on the grid
+   	      		vector<Grid> smallGrids=biasGrid.project(projs,Bw,&comm);
+                        for(unsigned k=0;k<smallGrids.size();k++){
+              		  OFile gridfile; gridfile.link(*this);
+	      		  std::ostringstream ostr;ostr<<nfiles;
+              		  string myout; 
+                          if(initstride>0){ myout=outhills+ostr.str()+".dat" ;}else{myout=outhills;}
+                          if(projs.size()>1) myout=projectionFileName(myout,projs[k]);
+              		  log<<"  Bias: Writing subgrid on file "<<myout<<" \n";
+              		  gridfile.open(myout);	
+                          if(minTOzero) smallGrids[k].setMinToZero();	
+        		  smallGrids[k].setOutputFmt(fmt); 
+   	      		  smallGrids[k].writeToFile(gridfile);
+              		  gridfile.close();
+                        }
                         if(!ibias)integratehills=false;// once you get to the final bunch just give up 
                         delete Bw;
 		}
@@ -47,6 +47,8 @@ public:
   Function(const ActionOptions&);
   virtual ~Function(){}
   void apply();
+/// Forces on the arguments only come from forces on the components
+  bool checkNeedsApply()const{return checkForForces();}
   static void registerKeywords(Keywords&);
   unsigned getNumberOfDerivatives();
 };
@@ -23,6 +23,8 @@
 #include "core/ActionPilot.h"
 #include "core/ActionSet.h"
 #include "core/PlumedMain.h"
+#include "tools/File.h"
+#include "tools/Stopwatch.h"
 
 using namespace std;
 
@@ -44,6 +46,18 @@ DEBUG DETAILED_TIMERS
 DEBUG logRequestedAtoms STRIDE=2
 \endverbatim
 
+The timers can also be written to a file during the simulation, so that
+the cost of each action can be monitored in long runs. The following
+writes all the timers in csv format every 1000 steps:
+\verbatim
+DEBUG TIMINGS_FILE=timings.csv STRIDE=1000
+\endverbatim
+For each timer the file contains the number of cycles, the total, average, minimum
+and maximum time together with estimates of the 50th, 90th and 99th percentile of the
+time of a single cycle. Timers with names starting with 4A and 5A are the time spent by
+each action in the forward (calculate) and backward (apply) loops, 2 and 3 are the time
+spent sharing the atoms between processes.
+
 */
 //+ENDPLUMEDOC
 class Debug:
@@ -53,6 +67,11 @@ class Debug:
   bool logRequestedAtoms;
   bool novirial;
   bool detailedTimers;
+  bool concurrentActions;
+  bool jsonTimings;
+  OFile timingsFile;
+/// Write all the timers to timingsFile
+  void writeTimings();
 public:
   Debug(const ActionOptions&ao);
 /// Register all the relevant keywords for the action  
@@ -71,6 +90,10 @@ void Debug::registerKeywords( Keywords& keys ){
   keys.addFlag("logRequestedAtoms",false,"write in the log which atoms have been requested at a given time");
   keys.addFlag("NOVIRIAL",false,"switch off the virial contribution for the entirity of the simulation");
   keys.addFlag("DETAILED_TIMERS",false,"switch on detailed timers");
+  keys.addFlag("CONCURRENT_ACTIONS",false,"perform actions that do not depend on each other at the same time using OpenMP threads. "
+                                          "When used with DETAILED_TIMERS the chain of dependent actions that takes the most time is written to the log");
+  keys.add("optional","TIMINGS_FILE","write the timers to this file every STRIDE steps. This switches on DETAILED_TIMERS");
+  keys.add("compulsory","TIMINGS_FORMAT","csv","the format of the TIMINGS_FILE. Either csv or json (one object per line)");
 }
 
 Debug::Debug(const ActionOptions&ao):
@@ -78,7 +101,10 @@ Action(ao),
 ActionPilot(ao),
 logActivity(false),
 logRequestedAtoms(false),
-novirial(false){
+novirial(false),
+detailedTimers(false),
+concurrentActions(false),
+jsonTimings(false){
   parseFlag("logActivity",logActivity);
   if(logActivity) log.printf("  logging activity\n");
   parseFlag("logRequestedAtoms",logRequestedAtoms);
@@ -86,9 +112,24 @@ novirial(false){
   parseFlag("NOVIRIAL",novirial);
   if(novirial) log.printf("  Switching off virial contribution\n");
   if(novirial) plumed.novirial=true;
+  std::string timings,format;
+  parse("TIMINGS_FILE",timings);
+  parse("TIMINGS_FORMAT",format);
+  if(format=="json") jsonTimings=true;
+  else if(format!="csv") error("TIMINGS_FORMAT should be either csv or json");
   parseFlag("DETAILED_TIMERS",detailedTimers);
+  if(timings.length()>0) detailedTimers=true;
   if(detailedTimers) log.printf("  Detailed timing on\n");
-  plumed.detailedTimers=true;
+  if(detailedTimers) plumed.detailedTimers=true;
+  if(timings.length()>0){
+    log.printf("  writing timers on file %s in %s format\n",timings.c_str(),format.c_str());
+    timingsFile.link(*this);
+    timingsFile.open(timings);
+    if(!jsonTimings) timingsFile.printf("step,time,timer,cycles,total,average,min,max,p50,p90,p99\n");
+  }
+  parseFlag("CONCURRENT_ACTIONS",concurrentActions);
+  if(concurrentActions) log.printf("  Performing independent actions concurrently\n");
+  if(concurrentActions) plumed.concurrentActions=true;
   checkRead();
 }
 
@@ -120,7 +161,31 @@ void Debug::apply(){
     log.printf("\n");
     plumed.cmd("clearFullList");
   }
+  if(timingsFile.isOpen()) writeTimings();
+}
 
+void Debug::writeTimings(){
+  const Stopwatch & sw(plumed.getStopwatch());
+  if(jsonTimings) timingsFile.printf("{\"step\":%ld,\"time\":%f,\"timers\":[",getStep(),getTime());
+  bool first=true;
+  for(unsigned i=0;i<sw.getNumberOfWatches();i++){
+    unsigned cycles=sw.getCycles(i);
+    if(cycles==0) continue;
+    double total=sw.getTotal(i);
+    const char* name=sw.getName(i).c_str();
+    if(jsonTimings){
+      if(!first) timingsFile.printf(",");
+      timingsFile.printf("{\"name\":\"%s\",\"cycles\":%u,\"total\":%.9f,\"average\":%.9f,\"min\":%.9f,\"max\":%.9f,\"p50\":%.9f,\"p90\":%.9f,\"p99\":%.9f}",
+                         name,cycles,total,total/cycles,sw.getMin(i),sw.getMax(i),
+                         sw.getPercentile(i,50),sw.getPercentile(i,90),sw.getPercentile(i,99));
+    } else {
+      timingsFile.printf("%ld,%f,\"%s\",%u,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f\n",
+                         getStep(),getTime(),name,cycles,total,total/cycles,sw.getMin(i),sw.getMax(i),
+                         sw.getPercentile(i,50),sw.getPercentile(i,90),sw.getPercentile(i,99));
+    }
+    first=false;
+  }
+  if(jsonTimings) timingsFile.printf("]}\n");
 }
 
 }
@@ -35,6 +35,7 @@
 
 #include "tools/File.h"
 #include "tools/Pbc.h"
+#include "tools/OpenMP.h"
 
 #include <algorithm>
 
@@ -182,7 +183,7 @@ void EffectiveEnergyDrift::update(){
   if(pbc){
     Tensor B=atoms.getPbc().getBox();
     Tensor IB=atoms.getPbc().getInvBox();
-#pragma omp parallel for
+#pragma omp parallel for num_threads(OpenMP::getGoodNumThreads(positions))
     for(int i=0;i<positions.size();++i){
       positions[i]=matmul(positions[i],IB);
       forces[i]=matmul(B,forces[i]);
@@ -261,7 +262,7 @@ void EffectiveEnergyDrift::update(){
   //compute the effective energy drift on local atoms
   
   double eed_tmp=eed;
-#pragma omp parallel for reduction(+:eed_tmp)
+#pragma omp parallel for reduction(+:eed_tmp) num_threads(OpenMP::getGoodNumThreads(positions))
   for(int i=0;i<nLocalAtoms;i++){
     Vector dst=delta(pPositions[i],positions[i]);
     if(pbc) for(unsigned k=0;k<3;k++) dst[k]=Tools::pbc(dst[k]);
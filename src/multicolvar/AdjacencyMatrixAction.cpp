@@ -181,22 +181,28 @@ void AdjacencyMatrixAction::retrieveMatrix( Matrix<double>& mymatrix ){
   }
 }
 
-void AdjacencyMatrixAction::retrieveAdjacencyLists( std::vector<unsigned>& nneigh, Matrix<unsigned>& adj_list ){
-  plumed_dbg_assert( nneigh.size()==getFullNumberOfBaseTasks() && adj_list.nrows()==getFullNumberOfBaseTasks() && 
-                       adj_list.ncols()==getFullNumberOfBaseTasks() );
+void AdjacencyMatrixAction::retrieveAdjacencyLists( std::vector<unsigned>& adj_start, std::vector<unsigned>& adj_list ){
+  plumed_dbg_assert( adj_start.size()==getFullNumberOfBaseTasks()+1 );
   // Gather active elements in matrix
   if(!gathered) active_elements.mpi_gatherActiveMembers( comm );
   gathered=true;
 
-  // Currently everything has zero neighbors
-  for(unsigned i=0;i<nneigh.size();++i) nneigh[i]=0;
+  // Count the number of neighbors of each node
+  adj_start.assign( adj_start.size(), 0 );
+  for(unsigned i=0;i<active_elements.getNumberActive();++i){
+      setMatrixIndexesForTask( i );
+      adj_start[current_atoms[0]+1]++; adj_start[current_atoms[1]+1]++;
+  }
+  for(unsigned i=1;i<adj_start.size();++i) adj_start[i]+=adj_start[i-1];
 
   // And set up the adjacency list
+  adj_list.resize( adj_start[adj_start.size()-1] ); 
+  std::vector<unsigned> nneigh( adj_start.begin(), adj_start.end()-1 );
   for(unsigned i=0;i<active_elements.getNumberActive();++i){
       setMatrixIndexesForTask( i );
       unsigned j = current_atoms[1], k = current_atoms[0];
-      adj_list(k,nneigh[k])=j; nneigh[k]++;
-      adj_list(j,nneigh[j])=k; nneigh[j]++;
+      adj_list[nneigh[k]]=j; nneigh[k]++;
+      adj_list[nneigh[j]]=k; nneigh[j]++;
   } 
 } 
 
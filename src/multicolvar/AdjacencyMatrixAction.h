@@ -51,8 +51,9 @@ protected:
   AdjacencyMatrixVessel* getAdjacencyVessel();
 /// Get the adjacency matrix
   void retrieveMatrix( Matrix<double>& mymatrix );
-/// Retrieve the adjacency lists
-  void retrieveAdjacencyLists( std::vector<unsigned>& nneigh, Matrix<unsigned>& adj_list );
+/// Retrieve the adjacency lists in compressed sparse row format (the neighbors of i are 
+/// in adj_list between adj_start[i] and adj_start[i+1])
+  void retrieveAdjacencyLists( std::vector<unsigned>& adj_start, std::vector<unsigned>& adj_list );
 /// Get number of active matrix elements
   unsigned getNumberOfActiveMatrixElements();
 /// Put the indices of the matrix elements in current atoms
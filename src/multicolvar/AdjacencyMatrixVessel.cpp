@@ -48,7 +48,7 @@ void AdjacencyMatrixVessel::setFinishedTrue(){
   finished=true;
 }
 
-void AdjacencyMatrixVessel::recompute( const unsigned& ivec, const unsigned& jstore ){
+void AdjacencyMatrixVessel::reperformTask( const unsigned& ivec, const unsigned& jstore ){
   plumed_dbg_assert( function->usingLowMem() && function->dertime );
   
   // Set the task we want to reperform
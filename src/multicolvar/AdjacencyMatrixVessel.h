@@ -48,7 +48,7 @@ public:
 /// This does nothing
   std::string description(){ return ""; }
 /// This recomputes the colvar
-  void recompute( const unsigned& ivec, const unsigned& jstore );
+  void reperformTask( const unsigned& ivec, const unsigned& jstore );
 /// Get the i,j th element of the matrix
   double getElement( const unsigned& ivec ); 
 /// Set the finished flag true
@@ -103,15 +103,12 @@ void MultiColvar::readAtomsLikeKeyword( const std::string & key, int& natoms, st
   }
   if( all_atoms.size()>0 ){
      current_atoms.resize( natoms ); nblock=ablocks[0].size(); 
-     if( natoms<4 ) resizeBookeepingArray( nblock, nblock ); 
 
      for(unsigned i=0;i<nblock;++i){
          if( natoms<4 ){
             unsigned cvcode=0, tmpc=1; 
             for(unsigned j=0;j<natoms;++j){ cvcode += i*tmpc; tmpc *= nblock; }
-            bookeeping(i,i).first=getFullNumberOfTasks();
             addTaskToList( cvcode ); 
-            bookeeping(i,i).second=getFullNumberOfTasks();
          } else {
             addTaskToList( i );
          }
@@ -141,24 +138,18 @@ void MultiColvar::readGroupsKeyword( int& natoms, std::vector<AtomNumber>& all_a
       for(unsigned i=0;i<t.size();++i) all_atoms.push_back( t[i] );
       if(natoms==2){ 
          nblock=t.size(); for(unsigned i=0;i<2;++i) ablocks[i].resize(nblock);
-         resizeBookeepingArray( nblock, nblock );
          for(unsigned i=0;i<t.size();++i){ ablocks[0][i]=i; ablocks[1][i]=i; }
          for(unsigned i=1;i<t.size();++i){ 
              for(unsigned j=0;j<i;++j){ 
-                bookeeping(i,j).first=getFullNumberOfTasks(); 
                 addTaskToList( i*nblock + j ); 
-                bookeeping(i,j).second=getFullNumberOfTasks(); 
              }
          }
       } else if(natoms==3){
          nblock=t.size(); for(unsigned i=0;i<3;++i) ablocks[i].resize(nblock); 
-         resizeBookeepingArray( nblock, nblock ); 
          for(unsigned i=0;i<t.size();++i){ ablocks[0][i]=i; ablocks[1][i]=i; ablocks[2][i]=i; }
          for(unsigned i=2;i<t.size();++i){
             for(unsigned j=1;j<i;++j){
-               bookeeping(i,j).first=getFullNumberOfTasks();
                for(unsigned k=0;k<j;++k) addTaskToList( i*nblock*nblock + j*nblock + k );
-               bookeeping(i,j).second=getFullNumberOfTasks();
             }
          }
       }
@@ -198,12 +189,9 @@ void MultiColvar::readTwoGroups( const std::string& key1, const std::string& key
   for(unsigned i=0;i<t2.size();++i){
      all_atoms.push_back( t2[i] ); ablocks[1][i]=t1.size() + i;
   }
-  resizeBookeepingArray( t1.size(), t2.size() ); 
   for(unsigned i=0;i<t1.size();++i){
      for(unsigned j=0;j<t2.size();++j){
-         bookeeping(i,j).first=getFullNumberOfTasks(); 
          if( all_atoms[ablocks[0][i]]!=all_atoms[ablocks[1][j]] ) addTaskToList( i*nblock + j );
-         bookeeping(i,j).second=getFullNumberOfTasks();
      }
   }
   if( !verbose_output ){
@@ -233,7 +221,7 @@ void MultiColvar::readThreeGroups( const std::string& key1, const std::string& k
   for(unsigned i=0;i<t2.size();++i){
      all_atoms.push_back( t2[i] ); ablocks[1][i] = t1.size() + i;
   }
-  resizeBookeepingArray( t1.size(), t2.size() ); parseAtomList(key3,t3);
+  parseAtomList(key3,t3);
   if( t3.empty() && !allow2 ){
       error("missing atom specification " + key3);
   } else if( t3.empty() ){
@@ -244,13 +232,11 @@ void MultiColvar::readThreeGroups( const std::string& key1, const std::string& k
       for(unsigned i=0;i<t2.size();++i) ablocks[2][i]=t1.size() + i;
       for(unsigned i=0;i<t1.size();++i){
         for(unsigned j=1;j<t2.size();++j){ 
-           bookeeping(i,j).first=getFullNumberOfTasks(); 
            for(unsigned k=0;k<j;++k){
               if( all_atoms[ablocks[0][i]]!=all_atoms[ablocks[1][j]] && 
                   all_atoms[ablocks[0][i]]!=all_atoms[ablocks[2][k]] && 
                   all_atoms[ablocks[1][j]]!=all_atoms[ablocks[2][k]] ) addTaskToList( nblock*nblock*i + nblock*j + k );
            }
-           bookeeping(i,j).second=getFullNumberOfTasks();
         }
       }
       if( !verbose_output ){
@@ -273,13 +259,11 @@ void MultiColvar::readThreeGroups( const std::string& key1, const std::string& k
       }
       for(unsigned i=0;i<t1.size();++i){
           for(unsigned j=0;j<t2.size();++j){
-              bookeeping(i,j).first=getFullNumberOfTasks();
               for(unsigned k=0;k<t3.size();++k){
                   if( all_atoms[ablocks[0][i]]!=all_atoms[ablocks[1][j]] && 
                       all_atoms[ablocks[0][i]]!=all_atoms[ablocks[2][k]] && 
                       all_atoms[ablocks[1][j]]!=all_atoms[ablocks[2][k]] ) addTaskToList( nblock*nblock*i + nblock*j + k );
               }
-              bookeeping(i,j).second=getFullNumberOfTasks();
           }
       }
       if( !verbose_output ){
@@ -24,6 +24,7 @@
 #include "BridgedMultiColvarFunction.h"
 #include "vesselbase/Vessel.h"
 #include "tools/Pbc.h"
+#include "tools/OpenMP.h"
 #include <vector>
 #include <string>
 
@@ -79,11 +80,37 @@ void MultiColvarBase::addTaskToList( const unsigned& taskCode ){
   ActionWithVessel::addTaskToList( taskCode );
 }
 
-void MultiColvarBase::resizeBookeepingArray( const unsigned& num1, const unsigned& num2 ){
-  bookeeping.resize( num1, num2 );
-  for(unsigned i=0;i<num1;++i){
-      for(unsigned j=0;j<num2;++j){ bookeeping(i,j).first=0; bookeeping(i,j).second=0; }
+void MultiColvarBase::setupBookeepingArray(){
+  // Tasks are added in order so all the tasks involving atom i of the first block 
+  // are contiguous and sorted by the index of the atom in the second block
+  bookeeping.assign( ablocks[0].size()+1, 0 );
+  unsigned lastblock=0, lastsecond=0;
+  for(unsigned k=0;k<getFullNumberOfTasks();++k){
+      unsigned iblock=getTaskCode(k) / decoder[0], jblock=getSecondBlockIndex( getTaskCode(k) );
+      plumed_massert( iblock<ablocks[0].size(), "task code is inconsistent with size of first block" );
+      plumed_massert( iblock>lastblock || (iblock==lastblock && jblock>=lastsecond), "tasks must be added in order to use link cells" );
+      bookeeping[iblock+1]++; lastblock=iblock; lastsecond=jblock;
   }
+  for(unsigned i=0;i<ablocks[0].size();++i) bookeeping[i+1]+=bookeeping[i];
+}
+
+void MultiColvarBase::getTasksInvolvingPair( const unsigned& i, const unsigned& j, unsigned& tstart, unsigned& tend ) const {
+  plumed_dbg_assert( i+1<bookeeping.size() );
+  // Binary search for the first task with second block index not less than j
+  unsigned lo=bookeeping[i], hi=bookeeping[i+1];
+  while( lo<hi ){
+     unsigned mid=lo + (hi-lo)/2;
+     if( getSecondBlockIndex( getTaskCode(mid) )<j ) lo=mid+1; 
+     else hi=mid;
+  }
+  tstart=lo; hi=bookeeping[i+1];
+  // And for the first task with second block index greater than j
+  while( lo<hi ){
+     unsigned mid=lo + (hi-lo)/2;
+     if( getSecondBlockIndex( getTaskCode(mid) )<=j ) lo=mid+1;
+     else hi=mid;
+  }
+  tend=lo;
 }
 
 void MultiColvarBase::setupMultiColvarBase(){
@@ -94,6 +121,8 @@ void MultiColvarBase::setupMultiColvarBase(){
   } 
   // Resize stuff here
   resizeLocalArrays();
+  // Setup the arrays that tell us which tasks involve which atoms
+  if( !usespecies && ablocks.size()>1 && ablocks.size()<4 ) setupBookeepingArray();
 
   // Setup underlying ActionWithVessel
   readVesselKeywords();
@@ -160,14 +189,23 @@ void MultiColvarBase::setupLinkCells(){
      if( serialCalculation() ){ stride=1; rank=0; }
 
      // Ensure we only do tasks where atoms are in appropriate link cells
-     std::vector<unsigned> linked_atoms( 1+ablocks[1].size() );
      std::vector<unsigned>  active_tasks( getFullNumberOfTasks(), 0 );
-     for(unsigned i=rank;i<ablocks[0].size();i+=stride){
-         if( !isCurrentlyActive( ablocks[0][i] ) ) continue;
-         natomsper=1; linked_atoms[0]=ltmp_ind[0];  // Note we always check atom 0 because it is simpler than changing LinkCells.cpp
-         linkcells.retrieveNeighboringAtoms( getPositionOfAtomForLinkCells( ablocks[0][i] ), natomsper, linked_atoms );
-         for(unsigned j=0;j<natomsper;++j){
-             for(unsigned k=bookeeping(i,linked_atoms[j]).first;k<bookeeping(i,linked_atoms[j]).second;++k) active_tasks[k]=1;
+     unsigned nt=OpenMP::getGoodNumThreads( active_tasks );
+     linkedAtomsBuffers.resize( nt, 1+ablocks[1].size() );
+
+     // Each atom in the first block only activates its own tasks so threads never write to the same element
+     #pragma omp parallel num_threads(nt)
+     {
+         std::vector<unsigned> & linked_atoms( linkedAtomsBuffers.getThreadBuffer() );
+         #pragma omp for 
+         for(unsigned i=rank;i<ablocks[0].size();i+=stride){
+             if( !isCurrentlyActive( ablocks[0][i] ) ) continue;
+             unsigned nlinked=1; linked_atoms[0]=ltmp_ind[0];  // Note we always check atom 0 because it is simpler than changing LinkCells.cpp
+             linkcells.retrieveNeighboringAtoms( getPositionOfAtomForLinkCells( ablocks[0][i] ), nlinked, linked_atoms );
+             for(unsigned j=0;j<nlinked;++j){
+                 unsigned tstart, tend; getTasksInvolvingPair( i, linked_atoms[j], tstart, tend );
+                 for(unsigned k=tstart;k<tend;++k) active_tasks[k]=1;
+             }
          }
      }
      if( !serialCalculation() ) comm.Sum( active_tasks ); 
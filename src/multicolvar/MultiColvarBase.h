@@ -26,6 +26,7 @@
 #include "core/ActionWithValue.h"
 #include "tools/DynamicList.h"
 #include "tools/LinkCells.h"
+#include "tools/OpenMP.h"
 #include "vesselbase/ActionWithVessel.h"
 #include "StoreColvarVessel.h"
 #include "StoreCentralAtomsVessel.h"
@@ -57,16 +58,23 @@ private:
   std::vector<double> forcesToApply;
 /// Stuff for link cells - this is used to make coordination number like variables faster
   LinkCells linkcells;
-/// This remembers where the boundaries are for the tasks. It makes link cells work fast
-  Matrix<std::pair<unsigned,unsigned> > bookeeping;
+/// This remembers where the tasks involving each atom in the first block start in the full task list. 
+/// It makes link cells work fast and its size scales with the number of atoms in the first block
+  std::vector<unsigned> bookeeping;
+/// Per-thread lists of the atoms in the neighboring link cells, allocated once
+  OpenMPBuffers<unsigned> linkedAtomsBuffers;
 /// A copy of the vessel containing the catoms
   StoreCentralAtomsVessel* mycatoms;
 /// A copy of the vessel containg the values of each colvar
   StoreColvarVessel* myvalues;
 /// This resizes the local arrays after neighbor list updates and during initialization
   void resizeLocalArrays();
-/// This resizes the arrays that are used for link cell update
-  void resizeBookeepingArray( const unsigned& num1, const unsigned& num2 );
+/// This sets up the arrays that are used for link cell update from the list of tasks
+  void setupBookeepingArray();
+/// Get the index of the second block atom involved in a particular task 
+  unsigned getSecondBlockIndex( const unsigned& taskCode ) const ;
+/// Get the range of tasks in the full task list that involve atom i of the first block and atom j of the second
+  void getTasksInvolvingPair( const unsigned& i, const unsigned& j, unsigned& tstart, unsigned& tend ) const ;
 protected:
 /// A dynamic list containing those atoms with derivatives
   DynamicList<unsigned> atoms_with_derivatives;
@@ -245,6 +253,11 @@ void MultiColvarBase::addBoxDerivativesOfWeight( const Tensor& vir ){
   addBoxDerivatives( 1, vir );
 }
 
+inline
+unsigned MultiColvarBase::getSecondBlockIndex( const unsigned& taskCode ) const {
+  return ( taskCode % decoder[0] ) / decoder[1];
+}
+
 inline
 unsigned MultiColvarBase::getSizeOfAtomsWithDerivatives(){
   return getNumberOfAtoms();
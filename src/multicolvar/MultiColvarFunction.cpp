@@ -58,6 +58,7 @@ wtolerance(0.0)
       }
       // Make sure we use low memory option in base colvar
       mycolv->setLowMemOption( usingLowMem() );
+      if( usingSparseMem() ) mycolv->setSparseMemOption( true );
       // Add the dependency
       addDependency(mycolv);
       // Ensure weights are considered
@@ -164,23 +165,18 @@ void MultiColvarFunction::buildAtomListWithPairs( const bool& allow_intra_group
      for(unsigned i=0;i<mybasemulticolvars[0]->getFullNumberOfTasks();++i) ablocks[0][i] = i;
      ablocks[1].resize( mybasemulticolvars[1]->getFullNumberOfTasks() ); unsigned istart = ablocks[0].size();
      for(unsigned i=0;i<mybasemulticolvars[1]->getFullNumberOfTasks();++i) ablocks[1][i] = istart + i;
-     resizeBookeepingArray( ablocks[0].size(), ablocks[1].size() );
      for(unsigned i=0;i<ablocks[0].size();++i){
          for(unsigned j=0;j<ablocks[1].size();++j){
-            bookeeping(i,j).first=getFullNumberOfTasks();
             addTaskToList( i*nblock + j );
-            bookeeping(i,j).second=getFullNumberOfTasks();
          }
      }
   } else {
      nblock = 0; for(unsigned i=0;i<mybasemulticolvars.size();++i) nblock += mybasemulticolvars[i]->getFullNumberOfTasks();
-     ablocks[0].resize( nblock ); ablocks[1].resize( nblock ); resizeBookeepingArray( nblock, nblock );
+     ablocks[0].resize( nblock ); ablocks[1].resize( nblock );
      for(unsigned i=0;i<nblock;++i){ ablocks[0][i] = i; ablocks[1][i] = i; }
      for(unsigned i=1;i<nblock;++i){
         for(unsigned j=0;j<i;++j){
-           bookeeping(i,j).first=getFullNumberOfTasks();
            addTaskToList( i*nblock + j );
-           bookeeping(i,j).second=getFullNumberOfTasks();
         }
      }
   }
@@ -22,12 +22,14 @@
 #include "core/Value.h"
 #include "Communicator.h"
 #include "BiasRepresentation.h"
+#include "OpenMP.h"
 #include <iostream>
+#include <algorithm>
 
 namespace PLMD {
 
 /// the constructor here
-BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc ):hasgrid(false),mycomm(cc),BiasGrid_(NULL){
+BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc ):hasgrid(false),nkernels(0),kernelchunk(100),mycomm(cc),BiasGrid_(NULL),mergedGrid_(NULL){
     doInt_=false;
     ndim=tmpvalues.size();
     for(int i=0;i<ndim;i++){
@@ -36,7 +38,7 @@ BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &c
     } 
 }
 /// overload the constructor: add the sigma  at constructor time 
-BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc,  vector<double> sigma ):hasgrid(false),histosigma(sigma),mycomm(cc),BiasGrid_(NULL){
+BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc,  vector<double> sigma ):hasgrid(false),nkernels(0),kernelchunk(100),histosigma(sigma),mycomm(cc),BiasGrid_(NULL),mergedGrid_(NULL){
     doInt_=false;
     ndim=tmpvalues.size();
     for(int i=0;i<ndim;i++){
@@ -46,7 +48,7 @@ BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &c
 } 
 /// overload the constructor: add the grid at constructor time 
 BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc , vector<string> gmin, vector<string> gmax, 
-                                       vector<unsigned> nbin, bool doInt, double lowI, double uppI ):hasgrid(false), rescaledToBias(false), mycomm(cc), BiasGrid_(NULL){
+                                       vector<unsigned> nbin, bool doInt, double lowI, double uppI ):hasgrid(false), rescaledToBias(false),nkernels(0),kernelchunk(100), mycomm(cc), BiasGrid_(NULL), mergedGrid_(NULL){
     ndim=tmpvalues.size();
     for(int  i=0;i<ndim;i++){
          values.push_back(tmpvalues[i]);
@@ -59,7 +61,7 @@ BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &c
     addGrid(gmin,gmax,nbin);
 } 
 /// overload the constructor with some external sigmas: needed for histogram
-BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc , vector<string> gmin, vector<string> gmax, vector<unsigned> nbin , vector<double> sigma):hasgrid(false), rescaledToBias(false),histosigma(sigma),mycomm(cc),BiasGrid_(NULL){
+BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &cc , vector<string> gmin, vector<string> gmax, vector<unsigned> nbin , vector<double> sigma):hasgrid(false), rescaledToBias(false),nkernels(0),kernelchunk(100),histosigma(sigma),mycomm(cc),BiasGrid_(NULL),mergedGrid_(NULL){
     doInt_=false;
     ndim=tmpvalues.size();
     for(int  i=0;i<ndim;i++){
@@ -72,11 +74,12 @@ BiasRepresentation::BiasRepresentation(vector<Value*> tmpvalues, Communicator &c
 
 BiasRepresentation::~BiasRepresentation(){
   if(BiasGrid_) delete BiasGrid_;
+  if(mergedGrid_) delete mergedGrid_;
   for(unsigned i=0;i<hills.size();i++) delete hills[i];
 }
 
 void  BiasRepresentation::addGrid( vector<string> gmin, vector<string> gmax, vector<unsigned> nbin ){
-    plumed_massert(hills.size()==0,"you can set the grid before loading the hills");
+    plumed_massert(nkernels==0,"you can set the grid before loading the hills");
     plumed_massert(hasgrid==false,"to build the grid you should not having the grid in this bias representation");
     string ss; ss="file.free"; 
     vector<Value*> vv;for(unsigned i=0;i<values.size();i++)vv.push_back(values[i]);
@@ -88,7 +91,7 @@ bool BiasRepresentation::hasSigmaInInput(){
    if(histosigma.size()==0){return false;}else{return true;} 
 }
 void BiasRepresentation::setRescaledToBias(bool rescaled){
-	plumed_massert(hills.size()==0,"you can set the rescaling function only before loading hills");
+	plumed_massert(nkernels==0,"you can set the rescaling function only before loading hills");
         rescaledToBias=rescaled;
 }
 const bool & BiasRepresentation::isRescaledToBias(){
@@ -152,71 +155,132 @@ void BiasRepresentation::pushKernel( IFile *ifile ){
 	      plumed_massert(maxi==maxv,"the input periodicity in hills and in value definition does not match"  ); 	
 	    }
         }
-        // if grid is defined then it should be added on the grid    
- 	//cerr<<"now with "<<hills.size()<<endl;
-        if(hasgrid){
+        nkernels++;
+        // if grid is defined then it should be added on the grid: this is done in chunks
+        if(hasgrid && hills.size()>=kernelchunk) depositKernels();
+}
+void BiasRepresentation::depositKernels(){
+        if(!hasgrid || hills.size()==0) return;
+        const unsigned nk=hills.size();
+        vector< vector<unsigned> > neighbors(nk);
+#pragma omp parallel for num_threads(OpenMP::getNumThreads())
+        for(int k=0;k<int(nk);k++){
+                 // separable kernels do not need the list of neighbors
+                 if(!doInt_ && hills[k]->isSeparable()) continue;
                  vector<unsigned> nneighb;
                  if(doInt_) nneighb=BiasGrid_->getNbin();
-                 else nneighb=kk->getSupport(BiasGrid_->getDx());
-                 vector<unsigned> neighbors=BiasGrid_->getNeighbors(kk->getCenter(),nneighb);
+                 else nneighb=hills[k]->getSupport(BiasGrid_->getDx());
+                 neighbors[k]=BiasGrid_->getNeighbors(hills[k]->getCenter(),nneighb);
+        }
+        // every process owns a contiguous block of grid points, so that no communication is needed here.
+        // The blocks of the processes are summed only when the grid is requested
+        const unsigned size=BiasGrid_->getSize();
+        const unsigned nproc=mycomm.Get_size();
+        const unsigned rank=mycomm.Get_rank();
+        const unsigned pfirst=(size/nproc)*rank+(rank<size%nproc?rank:size%nproc);
+        const unsigned psize=size/nproc+(rank<size%nproc?1:0);
+        // the kernels that reach each point of the block are collected once in a single list, with
+        // the kernels of point p in kernels[start[p]..start[p+1]), in the order in which they were added
+        vector<unsigned> start(psize+1,0);
+        for(unsigned k=0;k<nk;k++) for(unsigned i=0;i<neighbors[k].size();++i){
+                 const unsigned ineigh=neighbors[k][i];
+                 if(ineigh>=pfirst && ineigh<pfirst+psize) start[ineigh-pfirst+1]++;
+        }
+        for(unsigned p=0;p<psize;p++) start[p+1]+=start[p];
+        const unsigned nentries=start[psize];
+        vector<unsigned> kernels(nentries);
+        vector<unsigned> next(start.begin(),start.end()-1);
+        for(unsigned k=0;k<nk;k++) for(unsigned i=0;i<neighbors[k].size();++i){
+                 const unsigned ineigh=neighbors[k][i];
+                 if(ineigh>=pfirst && ineigh<pfirst+psize) kernels[next[ineigh-pfirst]++]=k;
+        }
+        // the block is split into nt contiguous chunks with about the same number of kernel evaluations
+        // (or of points, if all the kernels are separable), so that no two threads update the same point
+        unsigned nt=OpenMP::getNumThreads();
+        if(nt>psize) nt=psize;
+        if(nt==0) nt=1;
+        vector<unsigned> bound(nt+1,psize);
+        for(unsigned t=0;t<nt;t++){
+                 if(nentries>0) bound[t]=lower_bound(start.begin(),start.end(),unsigned((nentries*(unsigned long)t)/nt))-start.begin();
+                 else bound[t]=(psize/nt)*t+(t<psize%nt?t:psize%nt);
+        }
+        BiasGrid_->startBulkUpdate();
+#pragma omp parallel for num_threads(nt)
+        for(int t=0;t<int(nt);t++){
+                 const unsigned first=pfirst+bound[t];
+                 const unsigned last=pfirst+bound[t+1];
+                 // private copies of the values, since the kernels are evaluated on them
+                 vector<Value*> vv(ndim);
+                 for(int j=0;j<ndim;++j){
+                   vv[j]=new Value();
+                   if(values[j]->isPeriodic()){
+                     string mini,maxi; values[j]->getDomain(mini,maxi);
+                     vv[j]->setDomain(mini,maxi);
+                   } else vv[j]->setNotPeriodic();
+                 }
                  vector<double> der(ndim);
                  vector<double> xx(ndim);
-                 if(mycomm.Get_size()==1){
-                   for(unsigned i=0;i<neighbors.size();++i){
-                     unsigned ineigh=neighbors[i];
-                     for(int j=0;j<ndim;++j){der[j]=0.0;}
-                     BiasGrid_->getPoint(ineigh,xx);   
-                     // assign xx to a new vector of values
-                     for(int j=0;j<ndim;++j){values[j]->set(xx[j]);}
-                     double bias;	 
-                     if(doInt_) bias=kk->evaluate(values,der,true,doInt_,lowI_,uppI_);
-                     else bias=kk->evaluate(values,der,true);
-		     if(rescaledToBias){
-			double f=(biasf.back()-1.)/(biasf.back());
-			bias*=f;
-			for(int j=0;j<ndim;++j){der[j]*=f;}
+                 // separable kernels are added to the chunk as outer products
+                 if(!doInt_) for(unsigned k=0;k<nk;k++){
+                   if(!hills[k]->isSeparable()) continue;
+                   double f=1.0;
+                   if(rescaledToBias) f=(biasf[k]-1.)/(biasf[k]);
+                   const vector<double> & width(hills[k]->getWidth());
+                   for(int j=0;j<ndim;++j) xx[j]=1.0/width[j];
+                   BiasGrid_->addSeparableGaussian(hills[k]->getCenter(),xx,f*hills[k]->getHeight(),
+                                                   hills[k]->getSupport(BiasGrid_->getDx()),-1.0,first,last);
+                 }
+                 for(unsigned p=bound[t];p<bound[t+1];p++){
+                   if(start[p]==start[p+1]) continue;
+                   const unsigned ineigh=pfirst+p;
+                   BiasGrid_->getPoint(ineigh,xx);
+                   for(int j=0;j<ndim;++j){vv[j]->set(xx[j]);}
+                   for(unsigned n=start[p];n<start[p+1];n++){
+                     const unsigned k=kernels[n];
+                     double bias;
+                     if(doInt_) bias=hills[k]->evaluate(vv,der,true,doInt_,lowI_,uppI_);
+                     else bias=hills[k]->evaluate(vv,der,true);
+                     if(rescaledToBias){
+                       const double f=(biasf[k]-1.)/(biasf[k]);
+                       bias*=f;
+                       for(int j=0;j<ndim;++j){der[j]*=f;}
                      }
                      BiasGrid_->addValueAndDerivatives(ineigh,bias,der);
-                   } 
-                 } else {
-                   unsigned stride=mycomm.Get_size();
-                   unsigned rank=mycomm.Get_rank();
-                   vector<double> allder(ndim*neighbors.size(),0.0);
-                   vector<double> allbias(neighbors.size(),0.0);
-	           vector<double> tmpder(ndim); 
-                   for(unsigned i=rank;i<neighbors.size();i+=stride){
-                     unsigned ineigh=neighbors[i];
-                     BiasGrid_->getPoint(ineigh,xx);
-                     for(int j=0;j<ndim;++j){values[j]->set(xx[j]);}	 
-                     if(doInt_) allbias[i]=kk->evaluate(values,der,true,doInt_,lowI_,uppI_);
-                     else allbias[i]=kk->evaluate(values,der,true);
-		     if(rescaledToBias){
-			double f=(biasf.back()-1.)/(biasf.back());
-			allbias[i]*=f;
-			for(int j=0;j<ndim;++j){tmpder[j]*=f;}
-                     }
- 	             // this solution with the temporary vector is rather bad, probably better to take 		
-		     // a pointer of double as it was in old gaussian 
-                     for(int j=0;j<ndim;++j){ allder[ndim*i+j]=tmpder[j]; tmpder[j]=0.;}
-                   }
-                   mycomm.Sum(allbias);
-                   mycomm.Sum(allder);
-                   for(unsigned i=0;i<neighbors.size();++i){
-                     unsigned ineigh=neighbors[i];
-                     for(int j=0;j<ndim;++j){der[j]=allder[ndim*i+j];}
-                     BiasGrid_->addValueAndDerivatives(ineigh,allbias[i],der);
                    }
                  }
+                 for(int j=0;j<ndim;++j) delete vv[j];
         }
+        BiasGrid_->endBulkUpdate();
+        // once on the grid the kernels are not needed anymore
+        for(unsigned k=0;k<nk;k++) delete hills[k];
+        hills.clear();
+        biasf.clear();
 }
 int BiasRepresentation::getNumberOfKernels(){
-	return hills.size();
+	return nkernels;
 }
 Grid* BiasRepresentation::getGridPtr(){
         plumed_massert(hasgrid,"if you want the grid pointer then you should have defined a grid before"); 
-	return BiasGrid_;
+        depositKernels();
+        if(mycomm.Get_size()==1) return BiasGrid_;
+        if(mergedGrid_) delete mergedGrid_;
+        mergedGrid_=new Grid(*BiasGrid_);
+        const unsigned size=mergedGrid_->getSize();
+        vector<double> der(ndim);
+        vector<double> buffer(size*(ndim+1));
+        for(unsigned i=0;i<size;i++){
+          buffer[i*(ndim+1)]=mergedGrid_->getValueAndDerivatives(i,der);
+          for(int j=0;j<ndim;j++) buffer[i*(ndim+1)+1+j]=der[j];
+        }
+        mycomm.Sum(buffer);
+        for(unsigned i=0;i<size;i++){
+          for(int j=0;j<ndim;j++) der[j]=buffer[i*(ndim+1)+1+j];
+          mergedGrid_->setValueAndDerivatives(i,buffer[i*(ndim+1)],der);
+        }
+	return mergedGrid_;
 }
 void BiasRepresentation::getMinMaxBin(vector<double> &vmin, vector<double> &vmax, vector<unsigned> &vbin){
+	plumed_massert(!hasgrid,"kernels are not kept in memory when there is a grid");
 	vector<double> ss,cc,binsize; 
 	vmin.clear();vmin.resize(ndim,10.e20);
 	vmax.clear();vmax.resize(ndim,-10.e20);
@@ -257,6 +321,8 @@ void BiasRepresentation::clear(){
 	    delete *it;
         } 
         hills.clear(); 
+        biasf.clear();
+        nkernels=0;
         // clear the grid
         if(hasgrid){
               BiasGrid_->clear();
@@ -59,8 +59,11 @@ class BiasRepresentation {
 	  unsigned 	getNumberOfDimensions();
           /// add the grid to the representation
 	  void 		addGrid( vector<string> gmin, vector<string> gmax, vector<unsigned> nbin );
-          /// push a kernel on the representation (includes widths and height)
+          /// push a kernel on the representation (includes widths and height).
+          /// When there is a grid, kernels are buffered and added to it in chunks
 	  void 		pushKernel( IFile * ff);
+          /// add to the grid all the kernels that have been pushed but not deposited yet
+	  void 		depositKernels();
           /// set the flag that rescales the free energy to the bias 
 	  void 		setRescaledToBias(bool rescaled);
           /// check if the representation is rescaled to the bias 
@@ -77,7 +80,8 @@ class BiasRepresentation {
           const string & getName(unsigned i);
           /// get a pointer to a specific value
 	  Value* 	getPtrToValue(unsigned i);
-          /// get the pointer to the grid
+          /// get the pointer to the grid, after all the pushed kernels have been deposited.
+          /// In parallel runs this is a copy where the contributions of all the processes are summed
 	  Grid* 	getGridPtr();
           /// get a new histogram point from a file 
           KernelFunctions* readFromPoint(IFile *ifile); 
@@ -94,11 +98,18 @@ class BiasRepresentation {
     double uppI_;
     vector<Value*> values;
     vector<string> names;
+    /// kernels that are kept in memory: all of them without a grid, only the ones not yet deposited with a grid
     vector<KernelFunctions*> hills;
     vector<double> biasf;
+    /// total number of kernels pushed
+    unsigned nkernels;
+    /// number of kernels deposited together on the grid
+    unsigned kernelchunk;
     vector<double> histosigma;	
     Communicator& mycomm;
     Grid* BiasGrid_;
+    /// each process only fills its own block of BiasGrid_: this is where they are summed
+    Grid* mergedGrid_;
 };
 
 }
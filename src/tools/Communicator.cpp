@@ -140,6 +140,16 @@ void Communicator::Sum(Data data){
 #endif
 }
 
+Communicator::Request Communicator::Isum(Data data){
+  Request req;
+#if defined(__PLUMED_MPI) && MPI_VERSION>=3
+  if(initialized()) MPI_Iallreduce(MPI_IN_PLACE,data.pointer,data.size,data.type,MPI_SUM,communicator,&req.r);
+#else
+  Sum(data);
+#endif
+  return req;
+}
+
 Communicator::Request Communicator::Isend(ConstData data,int source,int tag){
   Request req;
 #ifdef __PLUMED_MPI
@@ -187,6 +197,20 @@ void Communicator::Allgather(ConstData in,Data out){
 #endif
 }
 
+Communicator::Request Communicator::Iallgather(ConstData in,Data out){
+  Request req;
+#if defined(__PLUMED_MPI) && MPI_VERSION>=3
+  plumed_massert(initialized(),"you are trying to use an MPI function, but MPI is not initialized");
+  void*s=const_cast<void*>((const void*)in.pointer);
+  void*r=const_cast<void*>((const void*)out.pointer);
+  if(s==NULL)s=MPI_IN_PLACE;
+  MPI_Iallgather(s,in.size,in.type,r,out.size/Get_size(),out.type,communicator,&req.r);
+#else
+  Allgather(in,out);
+#endif
+  return req;
+}
+
 void Communicator::Recv(Data data,int source,int tag,Status&status){
 #ifdef __PLUMED_MPI
   plumed_massert(initialized(),"you are trying to use an MPI function, but MPI is not initialized");
@@ -201,6 +225,19 @@ void Communicator::Recv(Data data,int source,int tag,Status&status){
 #endif
 }
 
+Communicator::Request Communicator::Irecv(Data data,int source,int tag){
+  Request req;
+#ifdef __PLUMED_MPI
+  plumed_massert(initialized(),"you are trying to use an MPI function, but MPI is not initialized");
+  MPI_Irecv(data.pointer,data.size,data.type,source,tag,communicator,&req.r);
+#else
+  (void) data;
+  (void) source;
+  (void) tag;
+  plumed_merror("you are trying to use an MPI function, but PLUMED has been compiled without MPI support");
+#endif
+  return req;
+}
 
 
 
@@ -224,14 +261,22 @@ bool Communicator::initialized(){
   else return false;
 }
 
+Communicator::Request::Request(){
+#ifdef __PLUMED_MPI
+  r=MPI_REQUEST_NULL;
+#endif
+}
+
 void Communicator::Request::wait(Status&s){
 #ifdef __PLUMED_MPI
+// requests from collectives that were done immediately are never started
+  if(r==MPI_REQUEST_NULL) return;
  plumed_massert(initialized(),"you are trying to use an MPI function, but MPI is not initialized");
   if(&s==&StatusIgnore) MPI_Wait(&r,MPI_STATUS_IGNORE);
   else MPI_Wait(&r,&s.s);
 #else
+// without MPI the only requests are those of collectives, which are done immediately
   (void) s;
-  plumed_merror("you are trying to use an MPI function, but PLUMED has been compiled without MPI support");
 #endif
 }
 
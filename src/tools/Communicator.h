@@ -137,6 +137,8 @@ public:
   class Request{
   public:
     MPI_Request r;
+/// Initialize to a request that is already completed
+    Request();
     void wait(Status&s=StatusIgnore);
   };
 /// Default constructor
@@ -182,6 +184,15 @@ public:
 /// Wrapper for MPI_Allreduce with MPI_SUM (reference)
   template <class T> void Sum(T&buf){Sum(Data(buf));}
 
+/// Wrapper for MPI_Iallreduce with MPI_SUM (data struct).
+/// The buffer should not be used until wait() has been called on the returned request.
+/// If the MPI library does not support nonblocking collectives this is done immediately
+  Request Isum(Data);
+/// Wrapper for MPI_Iallreduce with MPI_SUM (pointer)
+  template <class T> Request Isum(T*buf,int count){return Isum(Data(buf,count));}
+/// Wrapper for MPI_Iallreduce with MPI_SUM (reference)
+  template <class T> Request Isum(T&buf){return Isum(Data(buf));}
+
 /// Wrapper for MPI_Bcast (data struct)
   void Bcast(Data,int);
 /// Wrapper for MPI_Bcast (pointer)
@@ -216,12 +227,31 @@ public:
     Allgather(ConstData(sendbuf),Data(recvbuf));
   }
 
+/// Wrapper for MPI_Iallgather (data struct).
+/// The buffers should not be used until wait() has been called on the returned request.
+/// If the MPI library does not support nonblocking collectives this is done immediately
+  Request Iallgather(ConstData in,Data out);
+/// Wrapper for MPI_Iallgather (pointer)
+  template <class T,class S> Request Iallgather(const T*sendbuf,int sendcount,S*recvbuf,int recvcount){
+    return Iallgather(ConstData(sendbuf,sendcount),Data(recvbuf,recvcount*Get_size()));
+  }
+/// Wrapper for MPI_Iallgather (reference)
+  template <class T,class S> Request Iallgather(const T&sendbuf,S&recvbuf){
+    return Iallgather(ConstData(sendbuf),Data(recvbuf));
+  }
+
 /// Wrapper for MPI_Recv (data struct)
   void Recv(Data,int,int,Status&s=StatusIgnore);
 /// Wrapper for MPI_Recv (pointer)
   template <class T> void Recv(T*buf,int count,int source,int tag,Status&s=StatusIgnore){Recv(Data(buf,count),source,tag,s);}
 /// Wrapper for MPI_Recv (reference)
   template <class T> void Recv(T&buf,int source,int tag,Status&s=StatusIgnore){Recv(Data(buf),source,tag,s);}
+/// Wrapper for MPI_Irecv (data struct)
+  Request Irecv(Data,int,int);
+/// Wrapper for MPI_Irecv (pointer)
+  template <class T> Request Irecv(T*buf,int count,int source,int tag){return Irecv(Data(buf,count),source,tag);}
+/// Wrapper for MPI_Irecv (reference)
+  template <class T> Request Irecv(T&buf,int source,int tag){return Irecv(Data(buf),source,tag);}
 
 /// Wrapper to MPI_Comm_split
   void Split(int,int,Communicator&)const;
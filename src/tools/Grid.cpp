@@ -32,6 +32,8 @@
 #include "File.h"
 #include "Exception.h"
 #include "KernelFunctions.h"
+#include "Communicator.h"
+#include "OpenMP.h"
 
 using namespace std;
 namespace PLMD{
@@ -104,6 +106,9 @@ void Grid::Init(const std::string& funcl, const std::vector<std::string> &names,
  dospline_=dospline;
  usederiv_=usederiv;
  if(dospline_) plumed_assert(dospline_==usederiv_);
+ cachespline_=false;
+ gridversion_=1;
+ bulkupdate_=false;
  maxsize_=1;
  for(unsigned int i=0;i<dimension_;++i){
   dx_.push_back( (max_[i]-min_[i])/static_cast<double>( nbin_[i] ) );
@@ -114,6 +119,7 @@ void Grid::Init(const std::string& funcl, const std::vector<std::string> &names,
 }
 
 void Grid::clear(){
+ gridversion_++;
  grid_.resize(maxsize_);
  if(usederiv_) der_.resize(maxsize_);
  for(unsigned int i=0;i<maxsize_;++i){
@@ -325,6 +331,13 @@ vector<unsigned> Grid::getSplineNeighbors(const vector<unsigned> & indices)const
 void Grid::addKernel( const KernelFunctions& kernel ){
   plumed_dbg_assert( kernel.ndim()==dimension_ );
   std::vector<unsigned> nneighb=kernel.getSupport( dx_ );
+  if( kernel.isSeparable() ){
+      const std::vector<double> & width( kernel.getWidth() );
+      std::vector<double> invwidth( dimension_ );
+      for(unsigned i=0;i<dimension_;++i) invwidth[i]=1.0/width[i];
+      addSeparableGaussian( kernel.getCenter(), invwidth, kernel.getHeight(), nneighb, -1.0 );
+      return;
+  }
   std::vector<unsigned> neighbors=getNeighbors( kernel.getCenter(), nneighb );
   std::vector<double> xx( dimension_ ); std::vector<Value*> vv( dimension_ );
   std::string str_min, str_max;
@@ -352,6 +365,74 @@ void Grid::addKernel( const KernelFunctions& kernel ){
   for(unsigned i=0;i<dimension_;++i) delete vv[i];
 }
 
+void Grid::addSeparableGaussian(const vector<double> & center, const vector<double> & invsigma, double height,
+                                const vector<unsigned> & nneigh, double cutoff){
+ addSeparableGaussian(center,invsigma,height,nneigh,cutoff,0,maxsize_);
+}
+
+void Grid::addSeparableGaussian(const vector<double> & center, const vector<double> & invsigma, double height,
+                                const vector<unsigned> & nneigh, double cutoff, unsigned first, unsigned last){
+ plumed_dbg_assert(center.size()==dimension_ && invsigma.size()==dimension_ && nneigh.size()==dimension_);
+ const vector<unsigned> cindices(getIndices(center));
+// one dimensional factors: for each dimension and each point of the support the contribution 
+// to the index, half the square of the scaled distance, the Gaussian and the derivative of its log
+ vector<vector<unsigned> > offset(dimension_);
+ vector<vector<double> > half2(dimension_), factor(dimension_), dlog(dimension_);
+ unsigned stride=1;
+ for(unsigned j=0;j<dimension_;++j){
+  const int nb=nbin_[j];
+  for(int k=-int(nneigh[j]);k<=int(nneigh[j]);++k){
+   int i0=int(cindices[j])+k;
+   if(!pbc_[j] && (i0<0 || i0>=nb)) continue;
+   if(pbc_[j]) i0=((i0%nb)+nb)%nb;
+   double d=min_[j]+double(i0)*dx_[j]-center[j];
+   if(pbc_[j]){
+    const double period=max_[j]-min_[j];
+    d=Tools::pbc(d/period)*period;
+   }
+   const double dp=d*invsigma[j];
+   offset[j].push_back(unsigned(i0)*stride);
+   half2[j].push_back(0.5*dp*dp);
+   factor[j].push_back(exp(-0.5*dp*dp));
+   dlog[j].push_back(-dp*invsigma[j]);
+  }
+  if(offset[j].empty()) return;
+  stride*=nbin_[j];
+ }
+ if(last>maxsize_) last=maxsize_;
+
+// the first dimension is the innermost loop, so that the points are visited in memory order
+ const unsigned n0=offset[0].size();
+ vector<unsigned> k(dimension_,0);
+ vector<double> der(dimension_);
+ while(true){
+  unsigned base=0;
+  double f=height, h=0.0;
+  for(unsigned j=1;j<dimension_;++j){
+   base+=offset[j][k[j]];
+   f*=factor[j][k[j]];
+   h+=half2[j][k[j]];
+  }
+  for(unsigned i=0;i<n0;++i){
+   const unsigned index=base+offset[0][i];
+   if(index<first || index>=last) continue;
+   if(cutoff>=0.0 && h+half2[0][i]>=cutoff) continue;
+   const double value=f*factor[0][i];
+   if(usederiv_){
+    der[0]=value*dlog[0][i];
+    for(unsigned j=1;j<dimension_;++j) der[j]=value*dlog[j][k[j]];
+    addValueAndDerivatives(index,value,der);
+   } else addValue(index,value);
+  }
+  unsigned j=1;
+  for(;j<dimension_;++j){
+   if(++k[j]<offset[j].size()) break;
+   k[j]=0;
+  }
+  if(j==dimension_) break;
+ }
+}
+
 double Grid::getValue(unsigned index) const {
  plumed_dbg_assert(index<maxsize_);
  return grid_[index];
@@ -405,6 +486,7 @@ double Grid::getValueAndDerivatives
 (const vector<double> & x, vector<double>& der) const {
  plumed_dbg_assert(der.size()==dimension_ && usederiv_);
  
+ if(dospline_ && cachespline_) return getSplineFromCoefficients(x,der);
  if(dospline_){
   double X,X2,X3,value;
   vector<double> fd(dimension_);
@@ -453,8 +535,111 @@ double Grid::getValueAndDerivatives
  }
 }
 
+void Grid::setCacheSpline(bool s){
+ if(s){
+  plumed_massert(dospline_,"the spline coefficients can only be stored for a grid with spline");
+  plumed_massert(dimension_<=3,"the spline coefficients can only be stored for grids with up to three dimensions");
+  unsigned ncoeff=1;
+  for(unsigned j=0;j<dimension_;j++) ncoeff*=4;
+  splinecoeffs_.assign(ncoeff*maxsize_,0.0);
+  splinestamp_.assign(maxsize_,0);
+ } else {
+  splinecoeffs_.clear();
+  splinestamp_.clear();
+ }
+ cachespline_=s;
+}
+
+// This is the same interpolation as in getValueAndDerivatives(), written as
+// the sum over the corners of products of one-dimensional cubics in the
+// local coordinate t_j=(x_j-xfloor_j)/dx_j, which is expanded in powers of t_j
+void Grid::computeSplineCoefficients(unsigned cell) const {
+ unsigned ncoeff=1;
+ for(unsigned j=0;j<dimension_;j++) ncoeff*=4;
+ double* c=&splinecoeffs_[ncoeff*cell];
+ for(unsigned k=0;k<ncoeff;k++) c[k]=0.0;
+ vector<unsigned> indices=getIndices(cell);
+ vector<unsigned> nindices(dimension_);
+ vector<double> dder(dimension_);
+ double p[3][4];
+ unsigned ncorners=1<<dimension_;
+ for(unsigned icorner=0;icorner<ncorners;icorner++){
+  bool inside=true;
+  for(unsigned j=0;j<dimension_;j++){
+   unsigned i0=((icorner>>j)&1)+indices[j];
+   if(!pbc_[j] && i0==nbin_[j]) inside=false;
+   if( pbc_[j] && i0==nbin_[j]) i0=0;
+   nindices[j]=i0;
+  }
+  if(!inside) continue;
+  double grid=getValueAndDerivatives(getIndex(nindices),dder);
+  for(unsigned j=0;j<dimension_;j++){
+   int x0=1;
+   if(nindices[j]==indices[j]) x0=0;
+   double yy;
+   if(fabs(grid)<0.0000001) yy=0.0;
+     else yy=-dder[j]/grid;
+   double kk=(x0?-1.0:1.0)*yy*dx_[j];
+// coefficients in X=|t-x0|
+   double a0=1.0, a1=-kk, a2=-3.0+2.0*kk, a3=2.0-kk;
+   if(x0==0){
+    p[j][0]=a0; p[j][1]=a1; p[j][2]=a2; p[j][3]=a3;
+   } else {
+// X=1-t
+    p[j][0]=a0+a1+a2+a3;
+    p[j][1]=-a1-2.0*a2-3.0*a3;
+    p[j][2]=a2+3.0*a3;
+    p[j][3]=-a3;
+   }
+  }
+  for(unsigned k=0;k<ncoeff;k++){
+   double f=grid;
+   unsigned kk=k;
+   for(unsigned j=0;j<dimension_;j++){ f*=p[j][kk%4]; kk/=4; }
+   c[k]+=f;
+  }
+ }
+ splinestamp_[cell]=gridversion_;
+}
+
+double Grid::getSplineFromCoefficients(const vector<double> & x, vector<double>& der) const {
+ plumed_dbg_assert(x.size()==dimension_ && der.size()==dimension_);
+ double tp[3][4],dtp[3][4];
+ unsigned cell=0, stride=1;
+ for(unsigned j=0;j<dimension_;j++){
+  unsigned i=unsigned(floor((x[j]-min_[j])/dx_[j]));
+  if(i>=nbin_[j]) plumed_merror("ERROR: the system is looking for a value outside the grid");
+  double t=(x[j]-(min_[j]+(double)(i)*dx_[j]))/dx_[j];
+  tp[j][0]=1.0; tp[j][1]=t; tp[j][2]=t*t; tp[j][3]=t*t*t;
+  dtp[j][0]=0.0; dtp[j][1]=1.0; dtp[j][2]=2.0*t; dtp[j][3]=3.0*t*t;
+  cell+=i*stride;
+  stride*=nbin_[j];
+ }
+ if(splinestamp_[cell]!=gridversion_) computeSplineCoefficients(cell);
+ unsigned ncoeff=1;
+ for(unsigned j=0;j<dimension_;j++) ncoeff*=4;
+ const double* c=&splinecoeffs_[ncoeff*cell];
+ double value=0.0;
+ for(unsigned j=0;j<dimension_;j++) der[j]=0.0;
+ unsigned kj[3];
+ for(unsigned k=0;k<ncoeff;k++){
+  unsigned kk=k;
+  double f=c[k];
+  for(unsigned j=0;j<dimension_;j++){ kj[j]=kk%4; kk/=4; f*=tp[j][kj[j]]; }
+  value+=f;
+  for(unsigned j=0;j<dimension_;j++){
+   double d=c[k]*dtp[j][kj[j]];
+   for(unsigned i=0;i<dimension_;i++) if(i!=j) d*=tp[i][kj[i]];
+   der[j]+=d;
+  }
+ }
+ for(unsigned j=0;j<dimension_;j++) der[j]/=dx_[j];
+ return value;
+}
+
 void Grid::setValue(unsigned index, double value){
  plumed_dbg_assert(index<maxsize_ && !usederiv_);
+ if(!bulkupdate_) gridversion_++;
  grid_[index]=value;
 }
 
@@ -465,6 +650,7 @@ void Grid::setValue(const vector<unsigned> & indices, double value){
 void Grid::setValueAndDerivatives
  (unsigned index, double value, vector<double>& der){
  plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+ if(!bulkupdate_) gridversion_++;
  grid_[index]=value;
  der_[index]=der;
 }
@@ -476,6 +662,7 @@ void Grid::setValueAndDerivatives
 
 void Grid::addValue(unsigned index, double value){
  plumed_dbg_assert(index<maxsize_ && !usederiv_);
+ if(!bulkupdate_) gridversion_++;
  grid_[index]+=value;
 }
 
@@ -486,6 +673,7 @@ void Grid::addValue(const vector<unsigned> & indices, double value){
 void Grid::addValueAndDerivatives
  (unsigned index, double value, vector<double>& der){
  plumed_dbg_assert(index<maxsize_ && usederiv_ && der.size()==dimension_);
+ if(!bulkupdate_) gridversion_++;
  grid_[index]+=value;
  for(unsigned int i=0;i<dimension_;++i) der_[index][i]+=der[i];
 }
@@ -496,6 +684,7 @@ void Grid::addValueAndDerivatives
 }
 
 void Grid::scaleAllValuesAndDerivatives( const double& scalef ){
+  gridversion_++;
   if(usederiv_){
      for(unsigned i=0;i<grid_.size();++i){
          grid_[i]*=scalef;
@@ -507,6 +696,7 @@ void Grid::scaleAllValuesAndDerivatives( const double& scalef ){
 }
 
 void Grid::logAllValuesAndDerivatives( const double& scalef ){
+  gridversion_++;
   if(usederiv_){
      for(unsigned i=0;i<grid_.size();++i){
          grid_[i] = scalef*log(grid_[i]);
@@ -518,12 +708,14 @@ void Grid::logAllValuesAndDerivatives( const double& scalef ){
 }
 
 void Grid::setMinToZero(){
+  gridversion_++;
   double min=grid_[0];
   for(unsigned i=1;i<grid_.size();++i) if(grid_[i]<min) min=grid_[i];
   for(unsigned i=0;i<grid_.size();++i) grid_[i] -= min; 
 }
 
 void Grid::applyFunctionAllValuesAndDerivatives( double (*func)(double val), double (*funcder)(double valder) ){
+  gridversion_++;
   if(usederiv_){
      for(unsigned i=0;i<grid_.size();++i){
          grid_[i]=func(grid_[i]);
@@ -749,52 +941,14 @@ void SparseGrid::writeToFile(OFile& ofile){
 }
 
 
-void Grid::projectOnLowDimension(double &val, std::vector<int> &vHigh, WeightBase * ptr2obj ){
-    unsigned i=0;
-    for(i=0;i<vHigh.size();i++){
-       if(vHigh[i]<0){// this bin needs to be integrated out 
-          // parallelize here???
-    	  for(unsigned j=0;j<(getNbin())[i];j++){
-            vHigh[i]=int(j);  
-            projectOnLowDimension(val,vHigh,ptr2obj); // recursive function: this is the core of the mechanism
-            vHigh[i]=-1;
-          } 
-          return; // 
-       }
-    }
-    // when there are no more bin to dig in then retrieve the value 
-    if(i==vHigh.size()){
-        //std::cerr<<"POINT: "; 
-        //for(unsigned j=0;j<vHigh.size();j++){
-        //   std::cerr<<vHigh[j]<<" ";
-        //} 
-        std::vector<unsigned> vv(vHigh.size()); 
-        for(unsigned j=0;j<vHigh.size();j++)vv[j]=unsigned(vHigh[j]);
-        //
-        // this is the real assignment !!!!! (hack this to have bias or other stuff)
-        //
-
-        // this case: produce fes
-        //val+=exp(beta*getValue(vv)) ;
-        double myv=getValue(vv);
-        val=ptr2obj->projectInnerLoop(val,myv) ;
-        // to be added: bias (same as before without negative sign) 
-        //std::cerr<<" VAL: "<<val <<endl;
-    }
-}
-
-Grid Grid::project(const std::vector<std::string> & proj , WeightBase *ptr2obj ){
+Grid Grid::getProjectionGrid(const std::vector<std::string> & proj, std::vector<unsigned> & dimMapping)const{
          // find extrema only for the projection
          vector<string>   smallMin,smallMax;
          vector<unsigned> smallBin;
-         vector<unsigned> dimMapping;
          vector<bool> smallIsPeriodic;
          vector<string> smallName;
+         dimMapping.clear();
 
-         // check if the two key methods are there
-         WeightBase* pp = dynamic_cast<WeightBase*>(ptr2obj);
-         if (!pp)plumed_merror("This WeightBase is not complete: you need a projectInnerLoop and projectOuterLoop ");
- 
          for(unsigned j=0;j<proj.size();j++){
               for(unsigned i=0;i<getArgNames().size();i++){
                     if(proj[j]==getArgNames()[i]){ 
@@ -818,46 +972,140 @@ Grid Grid::project(const std::vector<std::string> & proj , WeightBase *ptr2obj )
               plumed_massert(  (smallgrid.getMin())[i] == (getMin())[dimMapping[i]],  "the two input grids are not compatible in min"   );  
               plumed_massert(  (smallgrid.getNbin())[i]== (getNbin())[dimMapping[i]], "the two input grids are not compatible in bin"   );  
          }
-         vector<unsigned> toBeIntegrated;
-         for(unsigned i=0;i<getArgNames().size();i++){
-              bool doappend=true;
-         	for(unsigned j=0;j<dimMapping.size();j++){
-                 if(dimMapping[j]==i){doappend=false; break;}  
-              }
-              if(doappend)toBeIntegrated.push_back(i);
+         return smallgrid;
+}
+
+Grid Grid::project(const std::vector<std::string> & proj , WeightBase *ptr2obj, Communicator* comm ){
+         vector< vector<string> > projs(1,proj);
+         return project(projs,ptr2obj,comm)[0];
+}
+
+std::vector<Grid> Grid::project(const std::vector< std::vector<std::string> > & projs , WeightBase *ptr2obj, Communicator* comm ){
+         // check if the two key methods are there
+         WeightBase* pp = dynamic_cast<WeightBase*>(ptr2obj);
+         if (!pp)plumed_merror("This WeightBase is not complete: you need a projectInnerLoop and projectOuterLoop ");
+         // exponentials of the bias are accumulated as a running maximum m and a sum s of exp(beta*v-m)
+         BiasWeight* bw=dynamic_cast<BiasWeight*>(ptr2obj);
+         const unsigned nacc=(bw?2:1);
+
+         // all the projections are stored one after the other in a single accumulator;
+         // stride[p][d] is the step in the accumulator when index d of this grid is increased by one
+         const unsigned nproj=projs.size();
+         vector<Grid> smallgrids;
+         vector< vector<unsigned> > stride(nproj,vector<unsigned>(dimension_,0));
+         vector<unsigned> start(nproj+1,0);
+         for(unsigned p=0;p<nproj;p++){
+              vector<unsigned> dimMapping;
+              smallgrids.push_back(getProjectionGrid(projs[p],dimMapping));
+              unsigned s=1;
+              for(unsigned j=0;j<dimMapping.size();j++){ stride[p][dimMapping[j]]=s; s*=smallgrids[p].getNbin()[j]; }
+              start[p+1]=start[p]+smallgrids[p].getSize();
          }
-         //for(unsigned i=0;i<dimMapping.size();i++ ){
-         //     cerr<<"Dimension to preserve "<<dimMapping[i]<<endl;
-         //}
-         //for(unsigned i=0;i<toBeIntegrated.size();i++ ){
-         //     cerr<<"Dimension to integrate "<<toBeIntegrated[i]<<endl;
-         //}
-
-         // loop over all the points in the Grid, find the corresponding fixed index, rotate over all the other ones  
-         for(unsigned i=0;i<smallgrid.getSize();i++){
-                 std::vector<unsigned> v;
-                 v=smallgrid.getIndices(i);
-                 std::vector<int> vHigh((getArgNames()).size(),-1);   
-                 for(unsigned j=0;j<dimMapping.size();j++)vHigh[dimMapping[j]]=int(v[j]);
-                 // the vector vhigh now contains at the beginning the index of the low dimension and -1 for the values that need to be integrated 
-                 double initval=0.;  
-                 projectOnLowDimension(initval,vHigh, ptr2obj); 
-                 smallgrid.setValue(i,initval);  
+         const unsigned ntot=start[nproj];
+
+         // each process takes a contiguous block of the grid
+         unsigned nproc=1,rank=0;
+         if(comm){ nproc=comm->Get_size(); rank=comm->Get_rank(); }
+         const unsigned pchunk=maxsize_/nproc, prem=maxsize_%nproc;
+         const unsigned pfirst=rank*pchunk+(rank<prem?rank:prem);
+         const unsigned psize=pchunk+(rank<prem?1:0);
+
+         vector<double> acc(nacc*ntot,0.0);
+         unsigned nt=OpenMP::getNumThreads();
+         if(nt*1000>psize) nt=psize/1000;
+         if(nt==0) nt=1;
+         vector< vector<double> > tacc(nt);
+
+#pragma omp parallel num_threads(nt)
+         {
+           // the runtime might give less threads than requested
+           const unsigned nteam=OpenMP::getTeamSize();
+           const unsigned it=OpenMP::getThreadNum();
+           vector<double> & mine(tacc[it]);
+           mine.assign(nacc*ntot,0.0);
+           const unsigned tchunk=psize/nteam, trem=psize%nteam;
+           const unsigned first=pfirst+it*tchunk+(it<trem?it:trem);
+           const unsigned last=first+tchunk+(it<trem?1:0);
+           if(first<last){
+             vector<unsigned> ind(getIndices(first));
+             vector<unsigned> k(nproj);
+             for(unsigned p=0;p<nproj;p++){
+               k[p]=start[p];
+               for(unsigned d=0;d<dimension_;d++) k[p]+=ind[d]*stride[p][d];
+             }
+             for(unsigned i=first;i<last;i++){
+               double v=getValue(i);
+               if(bw){
+                 const double x=bw->beta*v;
+                 for(unsigned p=0;p<nproj;p++){
+                   double & m(mine[2*k[p]]);
+                   double & s(mine[2*k[p]+1]);
+                   if(s==0.0){ m=x; s=1.0; }
+                   else if(x<=m) s+=exp(x-m);
+                   else { s=s*exp(m-x)+1.0; m=x; }
+                 }
+               } else {
+                 for(unsigned p=0;p<nproj;p++) mine[k[p]]=ptr2obj->projectInnerLoop(mine[k[p]],v);
+               }
+               // move to the next point, updating the indices in the projections incrementally
+               for(unsigned d=0;d<dimension_;d++){
+                 ind[d]++;
+                 for(unsigned p=0;p<nproj;p++) k[p]+=stride[p][d];
+                 if(ind[d]<nbin_[d]) break;
+                 for(unsigned p=0;p<nproj;p++) k[p]-=nbin_[d]*stride[p][d];
+                 ind[d]=0;
+               }
+             }
+           }
+#pragma omp barrier
+#pragma omp for
+           for(int j=0;j<int(ntot);j++){
+             if(bw){
+               double m=0.0,s=0.0;
+               for(unsigned t=0;t<nteam;t++){
+                 const double tm=tacc[t][2*j], ts=tacc[t][2*j+1];
+                 if(ts==0.0) continue;
+                 if(s==0.0){ m=tm; s=ts; }
+                 else if(tm<=m) s+=ts*exp(tm-m);
+                 else { s=s*exp(m-tm)+ts; m=tm; }
+               }
+               acc[2*j]=m; acc[2*j+1]=s;
+             } else {
+               for(unsigned t=0;t<nteam;t++) acc[j]+=tacc[t][j];
+             }
+           }
          }
-         // reset to zero just for biasing (this option can be evtl enabled in a future...) 
-         //double vmin;vmin=-smallgrid.getMinValue()+1;
-         for(unsigned i=0;i<smallgrid.getSize();i++){
-         //         //if(dynamic_cast<BiasWeight*>(ptr2obj)){
-	 //         //        smallgrid.addValue(i,vmin);// go to 1	
-         //         //}
-                  double vv=smallgrid.getValue(i); 
-                  smallgrid.setValue(i,ptr2obj->projectOuterLoop(vv));
- 	 //         //if(dynamic_cast<BiasWeight*>(ptr2obj)){
-	 //         //        smallgrid.addValue(i,-vmin);// bring back to the value	
-         //         //}
+
+         if(nproc>1){
+           if(bw){
+             // bring all the partial sums to the same maximum before summing them
+             vector<double> m(ntot),s(ntot),allm(ntot*nproc);
+             for(unsigned j=0;j<ntot;j++){ m[j]=acc[2*j]; s[j]=acc[2*j+1]; }
+             vector<double> mm(m);
+             for(unsigned j=0;j<ntot;j++) if(s[j]==0.0) mm[j]=-DBL_MAX;
+             comm->Allgather(&mm[0],ntot,&allm[0],ntot);
+             for(unsigned j=0;j<ntot;j++){
+               double mmax=-DBL_MAX;
+               for(unsigned r=0;r<nproc;r++) if(allm[r*ntot+j]>mmax) mmax=allm[r*ntot+j];
+               if(s[j]>0.0) s[j]*=exp(m[j]-mmax);
+               m[j]=mmax;
+             }
+             comm->Sum(&s[0],ntot);
+             for(unsigned j=0;j<ntot;j++){ acc[2*j]=m[j]; acc[2*j+1]=s[j]; }
+           } else comm->Sum(&acc[0],ntot);
+         }
+
+         for(unsigned p=0;p<nproj;p++){
+           for(unsigned i=0;i<smallgrids[p].getSize();i++){
+             const unsigned j=start[p]+i;
+             double vv;
+             if(bw && acc[2*j+1]>0.0) vv=-bw->invbeta*(acc[2*j]+std::log(acc[2*j+1]));
+             else { vv=acc[nacc*j+nacc-1]; vv=ptr2obj->projectOuterLoop(vv); }
+             smallgrids[p].setValue(i,vv);
+           }
          }
 
-     return smallgrid; 
+     return smallgrids; 
 }
 
 }
@@ -61,6 +61,7 @@ class ProbWeight:public WeightBase{
 
 
 class Value;
+class Communicator;
 class IFile;
 class OFile;
 class KernelFunctions;
@@ -70,6 +71,20 @@ class Grid
 {
  std::vector<double> grid_;
  std::vector< std::vector<double> > der_;
+/// if true the spline of each cell is stored as a polynomial, see setCacheSpline()
+ bool cachespline_;
+/// increased every time the grid is modified
+ unsigned long gridversion_;
+/// true between startBulkUpdate() and endBulkUpdate(), when the single point setters leave gridversion_ alone
+ bool bulkupdate_;
+/// 4^dimension_ polynomial coefficients per cell
+ mutable std::vector<double> splinecoeffs_;
+/// the value of gridversion_ when the coefficients of each cell were computed
+ mutable std::vector<unsigned long> splinestamp_;
+/// compute the polynomial coefficients of the spline in a cell
+ void computeSplineCoefficients(unsigned cell) const;
+/// evaluate the spline using the stored polynomial coefficients
+ double getSplineFromCoefficients(const std::vector<double> & x, std::vector<double>& der) const;
 protected:
  std::string funcname;
  std::vector<std::string> argnames;
@@ -82,6 +97,9 @@ protected:
  std::string fmt_; // format for output 
  /// get "neighbors" for spline
  std::vector<unsigned> getSplineNeighbors(const std::vector<unsigned> & indices)const;
+/// build the empty low dimensional grid used to project on the variables in proj;
+/// dimMapping is filled with the index of each of its dimensions in this grid
+ Grid getProjectionGrid(const std::vector<std::string> & proj, std::vector<unsigned> & dimMapping)const;
 
 
 public:
@@ -159,7 +177,7 @@ public:
  virtual double getValueAndDerivatives(const std::vector<unsigned> & indices, std::vector<double>& der) const;
  virtual double getValueAndDerivatives(const std::vector<double> & x, std::vector<double>& der) const;
 
-/// set grid value 
+/// set grid value
  virtual void setValue(unsigned index, double value);
  virtual void setValue(const std::vector<unsigned> & indices, double value);
 /// set grid value and derivatives
@@ -181,6 +199,16 @@ public:
  virtual void applyFunctionAllValuesAndDerivatives( double (*func)(double val), double (*funcder)(double valder) );
 /// add a kernel function to the grid
  void addKernel( const KernelFunctions& kernel );
+/// add a Gaussian with a diagonal metric, height*exp(-0.5*sum_j ((x_j-center_j)*invsigma_j)^2), 
+/// to the points that are within nneigh bins from the center. The Gaussian is computed as an outer 
+/// product of one dimensional factors, visiting the points in memory order. Points where the exponent 
+/// is not smaller than cutoff are skipped (a negative cutoff keeps all of them)
+ void addSeparableGaussian(const std::vector<double> & center, const std::vector<double> & invsigma, double height,
+                           const std::vector<unsigned> & nneigh, double cutoff);
+/// same, but only the points with index in [first,last) are updated. It can be called by several threads
+/// on disjoint ranges, in which case the calls should be enclosed by startBulkUpdate() and endBulkUpdate()
+ void addSeparableGaussian(const std::vector<double> & center, const std::vector<double> & invsigma, double height,
+                           const std::vector<unsigned> & nneigh, double cutoff, unsigned first, unsigned last);
 
 /// dump grid on file
  virtual void writeToFile(OFile&);
@@ -190,11 +218,29 @@ public:
  virtual ~Grid(){}
 
 /// project a high dimensional grid onto a low dimensional one: this should be changed at some time 
-/// to enable many types of weighting
- Grid project( const std::vector<std::string> & proj , WeightBase *ptr2obj  ); 
- void projectOnLowDimension(double &val , std::vector<int> &varHigh, WeightBase* ptr2obj ); 
+/// to enable many types of weighting.
+/// If comm is given, the work is split among its processes and all of them get the full projection
+ Grid project( const std::vector<std::string> & proj , WeightBase *ptr2obj, Communicator* comm=NULL ); 
+/// project a high dimensional grid onto several low dimensional ones in a single pass.
+/// The grid is visited in memory order and split among openMP threads and (if comm is given)
+/// among MPI processes. Partial results are combined assuming that projectInnerLoop accumulates additively,
+/// as it does for BiasWeight and ProbWeight. For BiasWeight the exponentials are summed with a log-sum-exp
+/// reduction, so that large biases do not overflow
+ std::vector<Grid> project( const std::vector< std::vector<std::string> > & projs , WeightBase *ptr2obj, Communicator* comm=NULL ); 
 /// set output format
  void setOutputFmt(std::string ss){fmt_=ss;}
+/// store the spline in each cell as a polynomial in the local coordinates, computed the first time
+/// the cell is used after the grid has been modified. Evaluation becomes a single polynomial evaluation
+/// instead of a reconstruction from the 2^d corners. It takes 4^d coefficients per point and is
+/// available up to three dimensions. It cannot be used with a SparseGrid, and a grid with this option
+/// should not be evaluated by several threads at the same time
+ void setCacheSpline(bool);
+/// from now on the single point setters do not mark the grid as modified, so that they can be called
+/// by several threads on disjoint points. It should not be called from a parallel region
+ void startBulkUpdate(){bulkupdate_=true;}
+/// mark the grid as modified once, so that the stored spline coefficients are recomputed, and
+/// go back to marking it at every call of the single point setters
+ void endBulkUpdate(){bulkupdate_=false; gridversion_++;}
 };
 
   
@@ -185,6 +185,16 @@ IFile& IFile::scanField(){
   return *this;
 }
 
+IFile& IFile::skipFields(unsigned long n){
+  plumed_assert(!inMiddleOfField);
+  for(unsigned long i=0;i<n;i++){
+    advanceField();
+    if(!*this) break;
+    inMiddleOfField=false;
+  }
+  return *this;
+}
+
 IFile::IFile():
   inMiddleOfField(false),
   ignoreFields(false)
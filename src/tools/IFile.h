@@ -83,6 +83,9 @@ Typically used as
 \endverbatim
 */
   IFile& scanField();
+/// Skip n field-formatted lines without reading their fields.
+/// Lines defining the fields are still interpreted
+  IFile& skipFields(unsigned long n);
 /// Get a full line as a string
   IFile& getline(std::string&);
 /// Reset end of file                                                              
@@ -54,6 +54,12 @@ public:
   unsigned ndim() const;
 /// Get the position of the center 
   std::vector<double> getCenter() const;
+/// Check if the kernel is a Gaussian with a diagonal metric, i.e. a product of one dimensional Gaussians
+  bool isSeparable() const;
+/// Get the widths of a kernel with a diagonal metric
+  const std::vector<double>& getWidth() const;
+/// Get the height of the kernel
+  double getHeight() const;
 /// Get the support
   std::vector<unsigned> getSupport( const std::vector<double>& dx ) const; 
 /// get it in continuous form
@@ -86,5 +92,21 @@ std::vector<double> KernelFunctions::getCenter() const {
   return center;
 }
 
+inline
+bool KernelFunctions::isSeparable() const {
+  return diagonal && ktype==gaussian;
+}
+
+inline
+const std::vector<double>& KernelFunctions::getWidth() const {
+  plumed_dbg_assert( diagonal );
+  return width;
+}
+
+inline
+double KernelFunctions::getHeight() const {
+  return height;
+}
+
 }
 #endif
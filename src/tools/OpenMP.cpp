@@ -22,22 +22,56 @@
 
 #include "OpenMP.h"
 #include "Tools.h"
+#include "Exception.h"
 #include <cstdlib>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace PLMD{
 
+// The environment is only read the first time these values are needed,
+// since they are retrieved at every step. Zero means not read yet.
+static unsigned cachelineSize=0;
+static unsigned numThreads=0;
+
 unsigned OpenMP::getCachelineSize(){
-  static unsigned cachelineSize=512;
-  if(std::getenv("PLUMED_CACHELINE_SIZE")) Tools::convert(std::getenv("PLUMED_CACHELINE_SIZE"),cachelineSize);
+  if(cachelineSize==0){
+    cachelineSize=512;
+    if(std::getenv("PLUMED_CACHELINE_SIZE")) Tools::convert(std::getenv("PLUMED_CACHELINE_SIZE"),cachelineSize);
+  }
   return cachelineSize;
 }
 
 unsigned OpenMP::getNumThreads(){
-  static unsigned numThreads=1;
-  if(std::getenv("PLUMED_NUM_THREADS")) Tools::convert(std::getenv("PLUMED_NUM_THREADS"),numThreads);
+  if(numThreads==0){
+    numThreads=1;
+    if(std::getenv("PLUMED_NUM_THREADS")) Tools::convert(std::getenv("PLUMED_NUM_THREADS"),numThreads);
+  }
   return numThreads;
 }
 
+void OpenMP::setNumThreads(unsigned nt){
+  plumed_massert(nt>0,"the number of threads should be at least one");
+  numThreads=nt;
+}
+
+unsigned OpenMP::getThreadNum(){
+#ifdef _OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+unsigned OpenMP::getTeamSize(){
+#ifdef _OPENMP
+  return omp_get_num_threads();
+#else
+  return 1;
+#endif
+}
+
 
 }
 
@@ -33,9 +33,19 @@ public:
 /// Get number of threads that can be used by openMP
 static unsigned getNumThreads();
 
+/// Set the number of threads that can be used by openMP.
+/// This overrides the PLUMED_NUM_THREADS environment variable
+static void setNumThreads(unsigned nt);
+
 /// get cacheline size
 static unsigned getCachelineSize();
 
+/// Get the index of the calling thread (0 outside parallel regions or without openMP)
+static unsigned getThreadNum();
+
+/// Get the number of threads in the current parallel region (1 outside parallel regions or without openMP)
+static unsigned getTeamSize();
+
 /// Get a reasonable number of threads so as to access to an array of size s located at x
 template<typename T>
 static unsigned getGoodNumThreads(const T*x,unsigned s);
@@ -46,6 +56,72 @@ static unsigned getGoodNumThreads(const std::vector<T> & v);
 
 };
 
+/// A pool of per-thread buffers that are allocated once and reused at every step.
+/// Each thread accumulates its contributions in its own buffer, and then
+/// the buffers are summed with reduce(). The reduction is split in blocks of
+/// elements among the threads, so that no critical section is needed.
+/// The buffers are set to zero when they are allocated and by reduce() once they
+/// have been added, so that they are ready for the next reduction.
+/// Typical usage is
+/// \verbatim
+/// buffers.resize(nt,n);
+/// #pragma omp parallel num_threads(nt)
+/// {
+///   std::vector<Vector> & mine(buffers.getThreadBuffer());
+///   #pragma omp for
+///   for(...) mine[i]+=...;
+///   buffers.reduce(result);
+/// }
+/// \endverbatim
+template<typename T>
+class OpenMPBuffers{
+  std::vector<std::vector<T> > buffers;
+public:
+/// Prepare nthreads buffers of n elements. Memory is only reallocated if the sizes change.
+  void resize(unsigned nthreads,unsigned n);
+/// Get the buffer of the calling thread
+  std::vector<T> & getThreadBuffer();
+/// Add the buffers of all the threads to result and set them back to zero.
+/// It should be called by all the threads of the parallel region
+  void reduce(std::vector<T> & result);
+/// Same as reduce, for a buffer of size one
+  void reduce(T & result);
+};
+
+template<typename T>
+void OpenMPBuffers<T>::resize(unsigned nthreads,unsigned n){
+  buffers.resize(nthreads);
+  for(unsigned i=0;i<nthreads;i++) if(buffers[i].size()!=n) buffers[i].assign(n,T());
+}
+
+template<typename T>
+std::vector<T> & OpenMPBuffers<T>::getThreadBuffer(){
+  return buffers[OpenMP::getThreadNum()];
+}
+
+template<typename T>
+void OpenMPBuffers<T>::reduce(std::vector<T> & result){
+  const int n=result.size();
+// the runtime might have given less threads than requested, and the other buffers are not used
+  unsigned nthreads=OpenMP::getTeamSize();
+  if(nthreads>buffers.size()) nthreads=buffers.size();
+// all the threads should have finished filling their buffer
+#pragma omp barrier
+#pragma omp for
+  for(int i=0;i<n;i++) for(unsigned t=0;t<nthreads;t++){ result[i]+=buffers[t][i]; buffers[t][i]=T(); }
+}
+
+template<typename T>
+void OpenMPBuffers<T>::reduce(T & result){
+#pragma omp barrier
+#pragma omp single
+  {
+    unsigned nthreads=OpenMP::getTeamSize();
+    if(nthreads>buffers.size()) nthreads=buffers.size();
+    for(unsigned t=0;t<nthreads;t++){ result+=buffers[t][0]; buffers[t][0]=T(); }
+  }
+}
+
 template<typename T>
 unsigned OpenMP::getGoodNumThreads(const T*x,unsigned n){
   unsigned long p=(unsigned long) x;
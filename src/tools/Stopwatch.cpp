@@ -24,6 +24,7 @@
 #include "Exception.h"
 
 #include <cstdio>
+#include <cmath>
 #include <iostream>
 
 /*
@@ -106,7 +107,7 @@ const Stopwatch::Time & Stopwatch::Time::operator+=(const Time&t2){
 }
 
 Stopwatch::Watch::Watch():
-  cycles(0),running(false),paused(false) { }
+  cycles(0),running(false),paused(false),histogram(64,0) { }
 
 void Stopwatch::Watch::start(){
   plumed_assert(!running);
@@ -120,6 +121,12 @@ void Stopwatch::Watch::stop(){
   total+=lap;
   if(lap>max)max=lap;
   if(min>lap || cycles==1)min=lap;
+// frexp gives the exponent of the binary representation, that is the index of the bin
+  int bin=0;
+  std::frexp(1000000000.0*double(lap),&bin);
+  if(bin<0) bin=0;
+  if(bin>=int(histogram.size())) bin=histogram.size()-1;
+  histogram[bin]++;
   lap.reset();
 } 
 
@@ -129,16 +136,49 @@ void Stopwatch::Watch::pause(){
   running=false;
 } 
 
+unsigned Stopwatch::getWatchIndex(const std::string & name){
+  map<string,unsigned>::const_iterator it=names.find(name);
+  if(it!=names.end()) return (*it).second;
+  unsigned index=watches.size();
+  watches.push_back(Watch());
+  names[name]=index;
+  return index;
+}
+
 void Stopwatch::start(const std::string & name){
-  watches[name].start();
+  watches[getWatchIndex(name)].start();
 }
 
 void Stopwatch::stop(const std::string & name){
-  watches[name].stop();
+  watches[getWatchIndex(name)].stop();
 }
 
 void Stopwatch::pause(const std::string & name){
-  watches[name].pause();
+  watches[getWatchIndex(name)].pause();
+}
+
+double Stopwatch::getTotal(const std::string & name)const{
+  map<string,unsigned>::const_iterator it=names.find(name);
+  if(it==names.end()) return 0.0;
+  return double(watches[(*it).second].total);
+}
+
+const std::string & Stopwatch::getName(unsigned index)const{
+  for(map<string,unsigned>::const_iterator it=names.begin();it!=names.end();++it) if((*it).second==index) return (*it).first;
+  plumed_merror("there is no stopwatch with this index");
+}
+
+double Stopwatch::getPercentile(unsigned index,double percentile)const{
+  const Watch&t(watches[index]);
+  if(t.cycles==0) return 0.0;
+  double target=0.01*percentile*t.cycles;
+  unsigned count=0;
+  for(unsigned i=0;i<t.histogram.size();i++){
+    count+=t.histogram[i];
+// bin i holds durations in [2^(i-1),2^i) nanoseconds, its geometric mid point is returned
+    if(count>=target && t.histogram[i]>0) return 0.000000001*std::pow(2.0,i-0.5);
+  }
+  return double(t.max);
 }
 
 
@@ -147,8 +187,10 @@ std::ostream& Stopwatch::log(std::ostream&os)const{
   buffer[0]=0;
   for(unsigned i=0;i<40;i++) os<<" ";
   os<<"      Cycles        Total      Average      Minumum      Maximum\n";
-  for(map<string,Watch>::const_iterator it=watches.begin();it!=watches.end();++it){
-    const Watch&t((*it).second);
+  for(map<string,unsigned>::const_iterator it=names.begin();it!=names.end();++it){
+    const Watch&t(watches[(*it).second]);
+// timers can be registered in advance and never used
+    if(t.cycles==0) continue;
     std::string name((*it).first);
     os<<name;
     for(unsigned i=name.length();i<40;i++) os<<" ";
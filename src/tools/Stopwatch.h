@@ -24,6 +24,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <iosfwd>
 
 namespace PLMD{
@@ -93,6 +94,30 @@ int main(){
 
 \endverbatim
 
+When a stopwatch is started and stopped very often (e.g. once per step)
+the lookup of its name can be avoided by registering it once with
+getWatchIndex() and then using the integer index:
+
+\verbatim
+#include "Stopwatch.h"
+
+int main(){
+  Stopwatch sw;
+  unsigned loop=sw.getWatchIndex("loop");
+  for(int i=0;i<100;i++){
+    sw.start(loop);
+// do calculation
+    sw.stop(loop);
+  }
+  return 0;
+}
+
+\endverbatim
+
+For each stopwatch the duration of the cycles is also collected in a
+histogram with logarithmically spaced bins, so that
+approximate percentiles can be retrieved with getPercentile().
+
 */
 
 class Stopwatch{
@@ -123,22 +148,50 @@ class Stopwatch{
     unsigned cycles;
     bool running;
     bool paused;
+/// Number of cycles whose duration in nanoseconds is in [2^(i-1),2^i)
+    std::vector<unsigned> histogram;
     void start();
     void stop();
     void pause();
   };
-  std::map<std::string,Watch> watches;
+/// The stopwatches, in the order in which they have been created
+  std::vector<Watch> watches;
+/// The names of the stopwatches and their position in watches
+  std::map<std::string,unsigned> names;
   std::ostream& log(std::ostream&)const;
 public:
+/// Get the index of timer named "name", creating it if needed.
+/// The index can be used in place of the name and is faster
+  unsigned getWatchIndex(const std::string&name);
 /// Start timer named "name"
   void start(const std::string&name);
+  void start(unsigned index);
   void start();
 /// Stop timer named "name"
   void stop(const std::string&name);
+  void stop(unsigned index);
   void stop();
 /// Pause timer named "name"
   void pause(const std::string&name);
+  void pause(unsigned index);
   void pause();
+/// Get the total time accumulated by timer named "name" (zero if it has never been used)
+  double getTotal(const std::string&name)const;
+/// Get the number of timers
+  unsigned getNumberOfWatches()const;
+/// Get the name of the index-th timer
+  const std::string & getName(unsigned index)const;
+/// Get the number of cycles completed by the index-th timer
+  unsigned getCycles(unsigned index)const;
+/// Get the total time accumulated by the index-th timer
+  double getTotal(unsigned index)const;
+/// Get the duration of the shortest cycle of the index-th timer
+  double getMin(unsigned index)const;
+/// Get the duration of the longest cycle of the index-th timer
+  double getMax(unsigned index)const;
+/// Get an estimate of the given percentile (between 0 and 100) of the
+/// duration of the cycles of the index-th timer. It is accurate within a factor sqrt(2)
+  double getPercentile(unsigned index,double percentile)const;
 /// Dump all timers on an ostream
   friend std::ostream& operator<<(std::ostream&,const Stopwatch&);
 };
@@ -158,6 +211,46 @@ void Stopwatch::pause(){
   pause("");
 }
 
+inline
+void Stopwatch::start(unsigned index){
+  watches[index].start();
+}
+
+inline
+void Stopwatch::stop(unsigned index){
+  watches[index].stop();
+}
+
+inline
+void Stopwatch::pause(unsigned index){
+  watches[index].pause();
+}
+
+inline
+unsigned Stopwatch::getNumberOfWatches()const{
+  return watches.size();
+}
+
+inline
+unsigned Stopwatch::getCycles(unsigned index)const{
+  return watches[index].cycles;
+}
+
+inline
+double Stopwatch::getTotal(unsigned index)const{
+  return double(watches[index].total);
+}
+
+inline
+double Stopwatch::getMin(unsigned index)const{
+  return double(watches[index].min);
+}
+
+inline
+double Stopwatch::getMax(unsigned index)const{
+  return double(watches[index].max);
+}
+
 }
 
 
@@ -45,6 +45,8 @@ void ActionWithVessel::registerKeywords(Keywords& keys){
                                      "we have to start using lowmem");
   keys.addFlag("SERIAL",false,"do the calculation in serial.  Do not parallelize");
   keys.addFlag("LOWMEM",false,"lower the memory requirements");
+  keys.addFlag("SPARSEMEM",false,"lower the memory requirements but store sparse copies of the derivatives of each quantity the first time it "
+                                 "is recomputed so that the underlying tasks are only reperformed once per step");
   keys.reserveFlag("HIGHMEM",false,"use a more memory intensive version of this collective variable");
   keys.add( vesselRegister().getKeywords() );
 }
@@ -53,6 +55,7 @@ ActionWithVessel::ActionWithVessel(const ActionOptions&ao):
   Action(ao),
   serial(false),
   lowmem(false),
+  sparsemem(false),
   noderiv(true),
   contributorsAreUnlocked(false),
   weightHasDerivatives(false)
@@ -72,6 +75,13 @@ ActionWithVessel::ActionWithVessel(const ActionOptions&ao):
      lowmem=!highmem;
      if(!lowmem) log.printf("  increasing the memory requirements\n");
   }
+  if( keywords.exists("SPARSEMEM") ){
+     parseFlag("SPARSEMEM",sparsemem);
+     if(sparsemem){
+        if(!lowmem && keywords.exists("HIGHMEM") ) error("cannot use SPARSEMEM and HIGHMEM at the same time");
+        lowmem=true; log.printf("  lowering memory requirements and storing sparse derivatives of recomputed quantities\n");
+     }
+  }
   tolerance=nl_tolerance=epsilon; 
   if( keywords.exists("TOL") ) parse("TOL",tolerance);
   if( tolerance>epsilon){
@@ -297,6 +307,30 @@ void ActionWithVessel::runAllTasks(){
   finishComputations();
 }
 
+void ActionWithVessel::packTaskFlags(){
+  // Each task is only performed on one node so summing the bits is the same as doing a logical or
+  // and the sums of 32 bits are exact in double precision
+  unsigned stride=comm.Get_size(), rank=comm.Get_rank();
+  unsigned nbits=32;
+  std::vector<unsigned> bits( 1 + nactive_tasks / nbits, 0 );
+  for(unsigned i=rank;i<nactive_tasks;i+=stride){
+     if( taskFlags[ indexOfTaskInFullList[i] ]>0 ) bits[i/nbits] |= ( 1u << (i%nbits) );
+  }
+  packedTaskFlags.resize( bits.size() );
+  for(unsigned i=0;i<bits.size();++i) packedTaskFlags[i]=bits[i];
+}
+
+void ActionWithVessel::unpackTaskFlags(){
+  unsigned nbits=32;
+  for(unsigned k=0;k<packedTaskFlags.size();++k){
+     unsigned bits=static_cast<unsigned>( packedTaskFlags[k] );
+     for(unsigned i=k*nbits;i<nactive_tasks && i<(k+1)*nbits;++i){
+        if( bits & ( 1u << (i%nbits) ) ) taskFlags[ indexOfTaskInFullList[i] ]=1;
+     }
+  }
+  packedTaskFlags.clear();
+}
+
 void ActionWithVessel::getIndexList( const unsigned& ntotal, const unsigned& jstore, const unsigned& maxder, std::vector<unsigned>& indices ){
   indices[jstore]=getNumberOfDerivatives();
   if( indices[jstore]>maxder ) error("too many derivatives to store. Run with LOWMEM");
@@ -330,12 +364,22 @@ bool ActionWithVessel::calculateAllVessels(){
 }
 
 void ActionWithVessel::finishComputations(){
-  // MPI Gather everything
-  if( !serial && buffer.size()>0 ) comm.Sum( buffer );
-  // Update the elements that are makign contributions to the sum here
+  // Update the elements that are making contributions to the sum here
   // this causes problems if we do it in prepare
-  if( !serial && contributorsAreUnlocked ) comm.Sum( taskFlags );
+  // The flags are reduced together with the buffer
+  packedTaskFlags.clear();
+  if( !serial && contributorsAreUnlocked ){
+     packTaskFlags();
+     addToSum( &packedTaskFlags[0], packedTaskFlags.size() );
+  }
+  // MPI Gather everything
+  if( !serial && buffer.size()>0 ) addToSum( &buffer[0], buffer.size() );
+  // When called from calculate the sum can be delayed, so nothing should be done after this
+  doSums();
+}
 
+void ActionWithVessel::finishCalculation(){
+  unpackTaskFlags();
   // Set the final value of the function
   for(unsigned j=0;j<functions.size();++j) functions[j]->finish(); 
 }
@@ -26,6 +26,7 @@
 #include "core/ActionAtomistic.h"
 #include "tools/Exception.h"
 #include "tools/DynamicList.h"
+#include "tools/Communicator.h"
 #include <vector>
 
 namespace PLMD{
@@ -55,6 +56,8 @@ private:
   bool serial;
 /// Lower memory requirements
   bool lowmem;
+/// Store sparse copies of the derivatives that are recomputed in lowmem mode
+  bool sparsemem;
 /// Are we skipping the calculation of the derivatives
   bool noderiv;
 /// The maximum number of derivatives we can use before we need to invoke lowmem
@@ -85,6 +88,13 @@ private:
   std::vector<unsigned> partialTaskList;
 /// This list is used to update the neighbor list
   std::vector<unsigned> taskFlags;
+/// The flags of the tasks deactivated on this node packed into bits for mpi.
+/// They are stored as doubles so that they are summed together with the buffer
+  std::vector<double> packedTaskFlags;
+/// Pack the flags of the tasks that have been deactivated on this node
+  void packTaskFlags();
+/// Update the flags once the packed flags have been summed over the nodes
+  void unpackTaskFlags();
 protected:
 /// A boolean that makes sure we don't accumulate very wrong derivatives
   std::vector<bool> thisval_wasset; 
@@ -132,6 +142,10 @@ protected:
   bool usingLowMem() const ;
 /// Set that we are using low memory
   void setLowMemOption(const bool& );
+/// Are we storing sparse copies of the recomputed derivatives
+  bool usingSparseMem() const ;
+/// Set that we are storing sparse copies of the recomputed derivatives
+  void setSparseMemOption(const bool& );
 /// Get the number of tasks that are currently active
   unsigned getCurrentNumberOfActiveTasks() const ;
 /// Get the ith of the currently active tasks
@@ -167,6 +181,10 @@ public:
   bool derivativesAreRequired() const ;
 /// Finish running all the calculations
   virtual void finishComputations();
+/// Set the final values once the buffer has been summed over the nodes
+  void finishCalculation();
+/// Tasks can be recomputed in the actions we depend on (e.g. in lowmem mode) so their state can change
+  bool checkModifiesDependencies()const{ return true; }
 /// Are the base quantities periodic
   virtual bool isPeriodic()=0;
 /// What are the domains of the base quantities
@@ -339,6 +357,16 @@ void ActionWithVessel::setLowMemOption(const bool& l){
   lowmem=l;
 }
 
+inline
+bool ActionWithVessel::usingSparseMem() const {
+  return sparsemem;
+}
+
+inline
+void ActionWithVessel::setSparseMemOption(const bool& s){
+  sparsemem=s;
+}
+
 inline
 unsigned ActionWithVessel::getCurrentTask() const {
   return current;
@@ -72,6 +72,9 @@ void StoreDataVessel::prepare(){
 // Clear bookeeping arrays  
   active_der.assign(active_der.size(),0);
   active_val.assign(active_val.size(),0);
+// Clear the sparse copies of the derivatives from the last step
+  if( usingSparseMem() ) sparse_start.assign( max_lowmem_stash*getAction()->getFullNumberOfTasks(), 0 );
+  sparse_index.resize(0); sparse_der.resize(0);
 }
 
 void StoreDataVessel::getIndexList( const unsigned& ntotal, const unsigned& jstore, const unsigned& maxder, std::vector<unsigned>& indices ){
@@ -85,6 +88,45 @@ void StoreDataVessel::setTaskToRecompute( const unsigned& ivec ){
 
 void StoreDataVessel::recompute( const unsigned& ivec, const unsigned& jstore ){
   plumed_dbg_assert( getAction()->derivativesAreRequired() && getAction()->lowmem && jstore<max_lowmem_stash );
+  if( !usingSparseMem() ){ reperformTask( ivec, jstore ); return; }
+
+  // Use the sparse copy of the derivatives if this quantity has been recomputed already
+  unsigned kstash = ivec*max_lowmem_stash + jstore;
+  if( sparse_start[kstash]>0 ){ 
+     setTaskToRecompute( ivec );
+     retrieveSparseDerivatives( sparse_start[kstash]-1, jstore ); 
+     return;
+  }
+  reperformTask( ivec, jstore );
+  sparse_start[kstash] = 1 + storeSparseDerivatives( jstore );
+}
+
+unsigned StoreDataVessel::storeSparseDerivatives( const unsigned& jstore ){
+  unsigned nder = getAction()->getNumberOfDerivatives(), nactive=active_der[jstore];
+  unsigned istart = sparse_index.size();
+  sparse_index.push_back( nactive ); sparse_index.push_back( sparse_der.size() );
+  unsigned kder = max_lowmem_stash + jstore*nder;
+  for(unsigned jder=0;jder<nactive;++jder) sparse_index.push_back( active_der[kder+jder] );
+  for(unsigned icomp=0;icomp<vecsize;++icomp){
+     unsigned ibuf = jstore * vecsize * nder + icomp*nder;
+     for(unsigned jder=0;jder<nactive;++jder) sparse_der.push_back( local_derivatives[ibuf+jder] );
+  }
+  return istart;
+}
+
+void StoreDataVessel::retrieveSparseDerivatives( const unsigned& istart, const unsigned& jstore ){
+  unsigned nder = getAction()->getNumberOfDerivatives(), nactive=sparse_index[istart];
+  active_der[jstore]=nactive; 
+  unsigned kder = max_lowmem_stash + jstore*nder;
+  for(unsigned jder=0;jder<nactive;++jder) active_der[kder+jder]=sparse_index[istart+2+jder];
+  unsigned kbuf = sparse_index[istart+1];
+  for(unsigned icomp=0;icomp<vecsize;++icomp){
+     unsigned ibuf = jstore * vecsize * nder + icomp*nder;
+     for(unsigned jder=0;jder<nactive;++jder){ local_derivatives[ibuf+jder]=sparse_der[kbuf]; kbuf++; }
+  }
+}
+
+void StoreDataVessel::reperformTask( const unsigned& ivec, const unsigned& jstore ){
   // Set the task we want to reperform
   setTaskToRecompute( ivec );
   // Reperform the task
@@ -198,26 +240,19 @@ void StoreDataVessel::chainRule( const unsigned& ival, const std::vector<double>
   // Clear final derivatives array
   final_derivatives.assign( final_derivatives.size(), 0.0 );
 
+  // Loop over components first so that the derivatives of each component are read contiguously
   if(getAction()->lowmem){
      plumed_dbg_assert( ival<max_lowmem_stash );
      unsigned maxder = getAction()->getNumberOfDerivatives();
-     for(unsigned ider=0;ider<active_der[ival];++ider){
-        final_derivatives[ider]=0.0;
-        unsigned ibuf=ival*(vecsize*maxder) + ider; 
-        for(unsigned jcomp=0;jcomp<vecsize;++jcomp){
-            final_derivatives[ider]+=df[jcomp]*local_derivatives[ibuf]; 
-            ibuf+=maxder;
-        }
+     for(unsigned jcomp=0;jcomp<vecsize;++jcomp){
+        const double* ders=&local_derivatives[ ival*(vecsize*maxder) + jcomp*maxder ];
+        for(unsigned ider=0;ider<active_der[ival];++ider) final_derivatives[ider]+=df[jcomp]*ders[ider];
      }
   } else {
      plumed_dbg_assert( ival<getAction()->getFullNumberOfTasks() );
-     for(unsigned ider=0;ider<active_der[ival];++ider){
-         final_derivatives[ider]=0.0;
-         unsigned ibuf=ival*(vecsize*nspace) + 1 + ider; 
-         for(unsigned jcomp=0;jcomp<vecsize;++jcomp){
-             final_derivatives[ider]+=df[jcomp]*getBufferElement(ibuf);
-             ibuf+=nspace;
-         }
+     for(unsigned jcomp=0;jcomp<vecsize;++jcomp){
+         unsigned ibuf=ival*(vecsize*nspace) + jcomp*nspace + 1;
+         for(unsigned ider=0;ider<active_der[ival];++ider) final_derivatives[ider]+=df[jcomp]*getBufferElement(ibuf+ider);
      }
   }
 }
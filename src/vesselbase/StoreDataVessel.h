@@ -61,6 +61,16 @@ private:
   std::vector<double> local_derivatives;
 /// The final derivatives
   std::vector<double> final_derivatives;
+/// Where the sparse copy of the derivatives of each recomputed quantity starts in sparse_index (zero if there is no copy)
+  std::vector<unsigned> sparse_start;
+/// The number of derivatives, the start in sparse_der and the indices of the derivatives of each sparse copy
+  std::vector<unsigned> sparse_index;
+/// The values of the derivatives in the sparse copies
+  std::vector<double> sparse_der;
+/// Store a sparse copy of the derivatives in the jstore th element of the lowmem stash
+  unsigned storeSparseDerivatives( const unsigned& jstore );
+/// Copy a sparse copy of the derivatives back into the jstore th element of the lowmem stash
+  void retrieveSparseDerivatives( const unsigned& istart, const unsigned& jstore );
 protected:
 /// Apply a hard cutoff on the weight
   bool hard_cut;
@@ -70,6 +80,8 @@ protected:
   bool weightHasDerivatives();
 /// Are we using low mem option
   bool usingLowMem();
+/// Are we storing sparse copies of the recomputed derivatives
+  bool usingSparseMem();
 /// Finish the setup of the storage object by setting how much
 /// data has to be stored
   void completeSetup( const unsigned& , const unsigned& );
@@ -109,7 +121,9 @@ public:
 /// Get a component of the stored vector
   double getComponent( const unsigned& , const unsigned& );
 /// Recalculate a vector - used in lowmem mode
-  virtual void recompute( const unsigned& , const unsigned& );
+  void recompute( const unsigned& , const unsigned& );
+/// Reperform the task to recalculate a vector in lowmem mode
+  virtual void reperformTask( const unsigned& , const unsigned& );
 /// This reperforms the task in the underlying action
   virtual void performTask( const unsigned& );
 /// This reperforms the task
@@ -147,6 +161,11 @@ bool StoreDataVessel::usingLowMem(){
   return getAction()->lowmem;
 }
 
+inline
+bool StoreDataVessel::usingSparseMem(){
+  return getAction()->sparsemem;
+}
+
 inline
 void StoreDataVessel::performTask( const unsigned& ivec ){
   if( usingLowMem() ) getAction()->performTask();
@@ -28,6 +28,7 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <string.h>
 
 /* DECLARATION USED ONLY IN THIS FILE */
 
@@ -156,6 +157,41 @@ void plumed_cmd(plumed p,const char*key,const void*val){
   (*(plumed_kernel_register(NULL)->cmd))(p.p,key,val);
 }
 
+/* This is set by plumed_cmd_handle the first time it is called, there is a single kernel */
+static void(*plumed_hcmd_function)(void*,int,const void*)=NULL;
+
+int plumed_cmd_handle(plumed p,const char*key){
+  int api=0;
+  int handle=-1;
+  char buffer[256];
+  plumed_function_holder ff;
+  plumed_cmd(p,"getApiVersion",&api);
+  if(api<3) return -1;
+  if(strlen(key)+strlen("getCommandHandle ")>=sizeof(buffer)) return -1;
+  strcpy(buffer,"getCommandHandle ");
+  strcat(buffer,key);
+  plumed_cmd(p,buffer,&handle);
+  if(!plumed_hcmd_function){
+    plumed_cmd(p,"getCommandHandleFunction",&ff);
+    plumed_hcmd_function=(void(*)(void*,int,const void*)) ff.p;
+  }
+  return handle;
+}
+
+void plumed_hcmd(plumed p,int handle,const void*val){
+/* these are checked also when NDEBUG is defined, since a call through a NULL pointer would just crash */
+  if(handle<0){
+    fprintf(stderr,"+++ ERROR: you are trying to use an invalid plumed command handle +++\n");
+    fprintf(stderr,"+++ Check the value returned by plumed_cmd_handle, this kernel might not support handles +++\n");
+    exit(1);
+  }
+  if(!plumed_hcmd_function){
+    fprintf(stderr,"+++ ERROR: you are trying to use plumed_hcmd before calling plumed_cmd_handle +++\n");
+    exit(1);
+  }
+  (*plumed_hcmd_function)(p.p,handle,val);
+}
+
 void plumed_finalize(plumed p){
   (*(plumed_kernel_register(NULL)->finalize))(p.p);
 }
@@ -108,6 +108,14 @@
   (FORTRAN)  PLUMED_F_GINITIALIZED
 \endverbatim
 
+  To send commands that are issued at every step without looking up their names each time,
+  first resolve the names into integer handles (this returns -1 if the kernel is too old) and 
+  then use the handles, e.g. plumed_hcmd(p,plumed_cmd_handle(p,"setStep"),&step)
+\verbatim
+  (C)        plumed_cmd_handle, plumed_hcmd
+  (C++)      PLMD::Plumed::cmdHandle, PLMD::Plumed::hcmd
+\endverbatim
+
   To check if plumed library is available (this is useful for runtime linking), use
 \verbatim
   (C)        plumed_installed 
@@ -223,6 +231,27 @@ plumed plumed_create(void);
 */
 void plumed_cmd(plumed p,const char*key,const void*val);
 
+/** \relates plumed
+    \brief Resolves the name of a command into an integer handle that can be used with plumed_hcmd()
+
+    \param p The plumed object on which command is acting
+    \param key The name of the command (only single word commands have handles)
+    \return The handle, or -1 if the plumed kernel does not support handles (API version lower than 3)
+*/
+int plumed_cmd_handle(plumed p,const char*key);
+
+/** \relates plumed
+    \brief Tells p to execute a command identified by a handle obtained from plumed_cmd_handle()
+
+    \param p The plumed object on which command is acting
+    \param handle The handle of the command to be executed
+    \param val The argument, as in plumed_cmd()
+
+    The program exits with an error if handle is negative (e.g. because the kernel does not support handles)
+    or if plumed_cmd_handle() has never been called.
+*/
+void plumed_hcmd(plumed p,int handle,const void*val);
+
 /** \relates plumed
     \brief Destructor
 
@@ -403,6 +432,18 @@ public:
                but for some choice of key it can change the content
 */
   void cmd(const char*key,const void*val=NULL);
+/**
+   Resolve the name of a command into an integer handle
+    \param key The name of the command
+    \return The handle, or -1 if the plumed kernel does not support handles
+*/
+  int cmdHandle(const char*key);
+/**
+   Send a command identified by a handle obtained from cmdHandle() to this plumed object
+    \param handle The handle of the command to be executed
+    \param val The argument, as in cmd()
+*/
+  void hcmd(int handle,const void*val=NULL);
 /**
    Destructor
 
@@ -456,6 +497,16 @@ void Plumed::cmd(const char*key,const void*val){
   plumed_cmd(main,key,val);
 }
 
+inline
+int Plumed::cmdHandle(const char*key){
+  return plumed_cmd_handle(main,key);
+}
+
+inline
+void Plumed::hcmd(int handle,const void*val){
+  plumed_hcmd(main,handle,val);
+}
+
 inline
 Plumed::~Plumed(){
   if(!reference)plumed_finalize(main);